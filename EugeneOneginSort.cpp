@@ -17,12 +17,17 @@
 
 #include <assert.h>
 #include <ctype.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include <winsock2.h>
+#include <afunix.h>
 #include <Windows.h>
 
+#pragma comment(lib, "Ws2_32.lib")
+
 /*!
  * Buffer for reading the input file into
  */
@@ -33,6 +38,41 @@ static char *BUFFER = NULL;
  */
 static const char *OUTPUT_FILE_NAME = "output.txt";
 
+/*!
+ * Constant defining the longest common prefix output file name of the multikey quick sort
+ */
+static const char *LCP_FILE_NAME = "lcp.txt";
+
+/*!
+ * Constant defining the size of the output file buffer, so that lines are written in large blocks
+ */
+static const size_t OUTPUT_BUFFER_SIZE = 1 << 16;
+
+/*!
+ * Constant defining the number of lines after which the incremental quick sort flushes the output file
+ */
+static const size_t INCREMENTAL_FLUSH_PERIOD = 256;
+
+/*!
+ * Constant defining the number of keys below which the multikey quick sort switches to the insertion sort
+ */
+static const size_t MULTIKEY_INSERTION_SORT_THRESHOLD = 16;
+
+/*!
+ * Constant defining the maximum length of a sort daemon request line
+ */
+static const size_t MAX_DAEMON_REQUEST_LEN = 4096;
+
+/*!
+ * Constant defining the maximum size of an inline payload of a sort daemon request
+ */
+static const size_t MAX_DAEMON_PAYLOAD_SIZE = 1 << 30;
+
+/*!
+ * Constant defining the time in milliseconds, for which the sort daemon waits for a client to send or receive data
+ */
+static const DWORD DAEMON_CLIENT_TIMEOUT_MS = 5000;
+
 /*!
  * Constant defining the number of mandatory command line arguments
  */
@@ -41,7 +81,17 @@ static const size_t N_MANDATORY_ARGS = 1;
 /*!
  * Constant defining the number of optional command line arguments
  */
-static const size_t N_OPTIONAL_ARGS = 3;
+static const size_t N_OPTIONAL_ARGS = 4;
+
+/*!
+ * Constant defining the default number of trailing letters of a line which make up its rhyme key
+ */
+static const size_t DEFAULT_RHYME_KEY_LEN = 3;
+
+/*!
+ * Constant defining the maximum number of trailing letters of a line which make up its rhyme key
+ */
+static const size_t MAX_RHYME_KEY_LEN = 16;
 
 /*!
  * Data structure defining text lines. Contains a pointer to char and length of the line
@@ -74,14 +124,92 @@ enum sort_mode {
  * Enum defining possible sort algorithms
  */
 enum sort_alg {
-    QUICK, TREE
+    QUICK, TREE, GROUP, GROUP_SORTED, INCREMENTAL, MULTIKEY
+};
+
+/*!
+ * Data structure defining the sort key of a line: its letters converted to lowercase, in the order in which the
+ * line comparator processes them
+ */
+struct sort_key_t {
+    const unsigned char *key;
+
+    line_t line;
+};
+
+/*!
+ * Data structure defining a group of lines sharing the same rhyme key. Is a slot of an open addressing hash table
+ */
+struct rhyme_group_t {
+    char key[MAX_RHYME_KEY_LEN];
+    size_t key_len;
+
+    size_t n_lines;
+    size_t offset;
+
+    bool used;
+};
+
+/*!
+ * Data structure defining an output file kept in memory. Contains the file name, a pointer to its contents,
+ * their size and the capacity of the allocated block
+ */
+struct memory_file_t {
+    const char *name;
+
+    char *data;
+    size_t size;
+    size_t capacity;
+};
+
+/*!
+ * Data structure defining an output, which is either a file or a memory file. Contains the number of characters
+ * written so far
+ */
+struct output_t {
+    FILE *file;
+    memory_file_t *memory_file;
+
+    size_t position;
 };
 
+/*!
+ * Memory files which replace the output files while USE_MEMORY_FILES is set
+ */
+static memory_file_t MEMORY_FILES[] = {{OUTPUT_FILE_NAME, NULL, 0, 0}, {LCP_FILE_NAME, NULL, 0, 0}};
+
+/*!
+ * Flag which makes the output go to MEMORY_FILES instead of the output files
+ */
+static bool USE_MEMORY_FILES = false;
+
+/*!
+ * The number of trailing letters of a line which make up its rhyme key, set by the "-k" option
+ */
+static size_t RHYME_KEY_LEN = DEFAULT_RHYME_KEY_LEN;
+
 
 typedef int comparator_func_t(const void *, const void *);
 typedef int sort_and_output_to_file_wrapper_func_t(const line_t *, size_t, comparator_func_t *);
 
 int eugene_onegin_sort(const char *input_file_name, sort_mode mode, sort_and_output_to_file_wrapper_func_t *sort_and_output_to_file);
+int sort_buffer_and_output_to_file(sort_mode mode, sort_and_output_to_file_wrapper_func_t *sort_and_output_to_file);
+int parse_sort_option(const char *arg, sort_mode *mode, sort_alg *alg, size_t *rhyme_key_len);
+sort_and_output_to_file_wrapper_func_t *get_sort_and_output_to_file(sort_alg alg);
+
+int run_sort_daemon(const char *socket_path);
+int remove_stale_socket(const char *socket_path, const sockaddr_un *address);
+int serve_sort_daemon_request(SOCKET client, bool *stop);
+int read_payload_to_buffer(SOCKET client, const char *received, size_t received_size, size_t payload_size);
+int send_to_client(SOCKET client, const char *data, size_t size);
+int send_sort_reply(SOCKET client);
+
+int open_output(output_t *output, const char *file_name, const char *open_mode);
+int write_to_output(output_t *output, const char *data, size_t size);
+int flush_output(output_t *output);
+int close_output(output_t *output);
+memory_file_t *get_memory_file(const char *file_name);
+void clear_memory_files(bool release);
 
 line_t *get_lines_from_buffer(size_t n_lines);
 size_t count_lines_in_buffer();
@@ -89,13 +217,30 @@ int read_file_to_buffer(const char *file_name);
 
 int q_sort_and_output_to_file(const line_t *lines, size_t n_lines, comparator_func_t *line_cmp);
 int write_lines_to_file(const line_t *lines, size_t n_lines, const char *open_mode);
+int write_line_to_file(output_t *output, const line_t *line);
+const char *get_poem_line(const line_t *line);
+
+int incremental_q_sort_and_output_to_file(const line_t *lines, size_t n_lines, comparator_func_t *line_cmp);
+void partition_lines(line_t *lines, size_t begin, size_t end, comparator_func_t *line_cmp,
+                     size_t *equal_begin, size_t *equal_end);
+
+int multikey_q_sort_and_output_to_file(const line_t *lines, size_t n_lines, comparator_func_t *line_cmp);
+unsigned char *get_sort_keys(const line_t *lines, size_t n_lines, bool reversed, sort_key_t *keys);
+void multikey_q_sort(sort_key_t *keys, size_t n_keys, size_t depth, size_t *lcps);
+int write_lcps_to_file(const sort_key_t *keys, const size_t *lcps, size_t n_keys);
 
 int tree_sort_and_output_to_file(const line_t *lines, size_t n_lines, comparator_func_t *line_cmp);
 node_t *generate_bst(const line_t *lines, size_t n_lines, comparator_func_t *line_cmp);
 const node_t *insert_node_into_bst(node_t *parent, line_t line, comparator_func_t *line_cmp);
-int write_bst_to_file(FILE *output, const node_t *current);
+int write_bst_to_file(output_t *output, const node_t *current);
 void delete_bst(node_t *current);
 
+int group_and_output_to_file(const line_t *lines, size_t n_lines, comparator_func_t *line_cmp);
+int group_sort_and_output_to_file(const line_t *lines, size_t n_lines, comparator_func_t *line_cmp);
+int group_lines_and_output_to_file(const line_t *lines, size_t n_lines, comparator_func_t *line_cmp);
+size_t get_rhyme_key(const line_t *line, char *key);
+size_t hash_rhyme_key(const char *key, size_t key_len);
+
 int is_alpha(int c);
 int to_lower(int c);
 int line_cmp_direct(const void *line1, const void *line2);
@@ -113,6 +258,20 @@ int main(int argc, const char *argv[])
         return EXIT_FAILURE;
     }
 
+    if ((strcmp(argv[1], "-d") == 0) || (strcmp(argv[1], "--daemon") == 0)) {
+        if (argc < 2) {
+            printf("Please rerun the program and specify the daemon socket path after \"-d\" or \"--daemon\"\n");
+            return EXIT_FAILURE;
+        }
+
+        if (run_sort_daemon(argv[2])) {
+            ERROR_OCCURRED_CALLING(run_sort_daemon, "returned a non-zero value");
+            return EXIT_FAILURE;
+        }
+
+        return EXIT_SUCCESS;
+    }
+
     const char *input_file_name = argv[1];
     argc -= N_MANDATORY_ARGS;
 
@@ -124,14 +283,8 @@ int main(int argc, const char *argv[])
 
     size_t matched_args = 0;
 
-    for (size_t i = 2; i < argc; ++i) {
-        if ((strcmp(argv[i], "-r") == 0) || (strcmp(argv[i], "--reversed") == 0)) {
-            mode = REVERSED;
-            ++matched_args;
-        }
-
-        if ((strcmp(argv[i], "-q") == 0) || (strcmp(argv[i], "--quick") == 0)) {
-            alg = QUICK;
+    for (size_t i = N_MANDATORY_ARGS + 1; i < N_MANDATORY_ARGS + 1 + argc; ++i) {
+        if (parse_sort_option(argv[i], &mode, &alg, &RHYME_KEY_LEN)) {
             ++matched_args;
         }
 
@@ -141,21 +294,29 @@ int main(int argc, const char *argv[])
         }
     }
 
-    if (matched_args != argc - N_OPTIONAL_ARGS + 1) {
+    if ((matched_args != (size_t) argc) || ((size_t) argc > N_OPTIONAL_ARGS)) {
         printf("Invalid optional command line arguments (must be \"-reversed\" or \"--r\" and \"-quick\"\n"
-               "or \"--q\") - using correctly matched arguments or defaults");
+               "or \"--q\" or \"-incremental\" or \"--i\" or \"-multikey\" or \"--m\" or \"-group\" or \"--g\" or\n"
+               "\"-group-sorted\" or \"--gs\" and \"-k<K>\" or \"--key-length=<K>\" with K from 1 to 16) - using\n"
+               "correctly matched arguments or defaults\n");
     }
 
     if (verbose) {
         printf("Poem lines from input file (mandatory first command line argument) will be sorted and written to output file\n"
                "\"output.txt\". The order in which 2 lines are processed during comparison is direct by default or reversed\n"
                "(set by optional command line argument \"-reversed\" or \"--r\"). The sort algorithm is tree sort by\n"
-               "default or quick sort (set by optional command line argument \"-quick\" or \"--q\"). Also, the original\n"
-               "text will be appended to the output file\n\n");
+               "default or quick sort (set by optional command line argument \"-quick\" or \"--q\") or incremental quick\n"
+               "sort, which writes lines as soon as their positions are known (set by optional command line argument\n"
+               "\"-incremental\" or \"--i\") or multikey quick sort, which also writes the longest common prefixes of\n"
+               "adjacent lines to \"lcp.txt\" (set by optional command line argument \"-multikey\" or \"--m\"). Instead of\n"
+               "sorting, lines can be grouped by their last letters (set by optional command line argument \"-group\" or\n"
+               "\"--g\", or \"-group-sorted\" or \"--gs\" to also sort lines inside each group), 3 by default or K\n"
+               "(set by optional command line argument \"-k<K>\" or \"--key-length=<K>\"). Also, the original text\n"
+               "will be appended to the output file. Run with \"-d\" or \"--daemon\" and a socket path instead of the\n"
+               "input file to serve sort requests over a Unix domain socket\n\n");
     }
 
-    int error_code =
-            eugene_onegin_sort(input_file_name, mode, (alg == TREE) ? tree_sort_and_output_to_file : q_sort_and_output_to_file);
+    int error_code = eugene_onegin_sort(input_file_name, mode, get_sort_and_output_to_file(alg));
 
     switch (error_code) {
     case 0: {
@@ -188,12 +349,33 @@ int main(int argc, const char *argv[])
  */
 int eugene_onegin_sort(const char *input_file_name, sort_mode mode, sort_and_output_to_file_wrapper_func_t *sort_and_output_to_file)
 {
-    if (read_file_to_buffer(input_file_name)) {
+    int read_file_to_buffer_error_code = read_file_to_buffer(input_file_name);
+
+    if (read_file_to_buffer_error_code == 1) {
+        return 1;
+    }
+
+    if (read_file_to_buffer_error_code) {
         ERROR_OCCURRED_CALLING(read_file_to_buffer, "returned a non-zero value");
 
         return -1;
     }
 
+    return sort_buffer_and_output_to_file(mode, sort_and_output_to_file);
+}
+
+/*!
+ * Poem lines from BUFFER will be sorted and written to output file, then BUFFER is freed
+ *
+ * @param [in] mode enum constant which sets the sort mode ('d' or 'r')
+ * @param [in] sort_and_output_to_file pointer to function which does the sorting and output
+ *
+ * @return 0 in case of success, 1 in case BUFFER has no lines, a different non-zero value otherwise
+ *
+ * @note The output file name is OUTPUT_FILE_NAME
+ */
+int sort_buffer_and_output_to_file(sort_mode mode, sort_and_output_to_file_wrapper_func_t *sort_and_output_to_file)
+{
     assert(BUFFER);
 
     size_t n_lines = count_lines_in_buffer();
@@ -228,257 +410,1430 @@ int eugene_onegin_sort(const char *input_file_name, sort_mode mode, sort_and_out
     FREE(BUFFER);
     FREE(lines);
 
-    return sort_and_output_to_file_error_flag && write_lines_to_file_error_flag;
+    return sort_and_output_to_file_error_flag || write_lines_to_file_error_flag;
 }
 
 /*!
- * Gets lines from BUFFER by tokenizing it
+ * Parses a sort option, which sets the sort mode, the sort algorithm or the rhyme key length
  *
- * @param [out] n_lines number of lines in BUFFER
- *
- * @return pointer to an array of retrieved lines
+ * @param [in] arg the option
+ * @param [in, out] mode pointer to sort mode, set if arg is a sort mode option
+ * @param [in, out] alg pointer to sort algorithm, set if arg is a sort algorithm option
+ * @param [in, out] rhyme_key_len pointer to rhyme key length, set if arg is a valid rhyme key length option
  *
- * @note Returns NULL in case of failure
+ * @return 1 if arg is a sort option, otherwise 0
  */
-line_t *get_lines_from_buffer(size_t n_lines)
+int parse_sort_option(const char *arg, sort_mode *mode, sort_alg *alg, size_t *rhyme_key_len)
 {
-    line_t *lines = (line_t *) calloc(n_lines + 1, sizeof(*lines));
+    assert(arg != NULL);
+    assert(mode != NULL);
+    assert(alg != NULL);
+    assert(rhyme_key_len != NULL);
 
-    if (lines == NULL) {
-        ERROR_OCCURRED_CALLING(calloc, "returned NULL");
+    if ((strcmp(arg, "-r") == 0) || (strcmp(arg, "--reversed") == 0)) {
+        *mode = REVERSED;
+        return 1;
+    }
 
-        return NULL;
+    if ((strcmp(arg, "-q") == 0) || (strcmp(arg, "--quick") == 0)) {
+        *alg = QUICK;
+        return 1;
     }
 
-    if ((lines[0].str = strtok(BUFFER + 1, "\r\n")) == NULL) {
-        ERROR_OCCURRED_CALLING(strtok, "returned NULL");
+    if ((strcmp(arg, "-m") == 0) || (strcmp(arg, "--multikey") == 0)) {
+        *alg = MULTIKEY;
+        return 1;
+    }
 
-        return NULL;
+    if ((strcmp(arg, "-i") == 0) || (strcmp(arg, "--incremental") == 0)) {
+        *alg = INCREMENTAL;
+        return 1;
     }
-    lines[0].str[-1] = '\0';
-    lines[0].len = strlen(lines[0].str);
 
-    for (size_t i = 1; i < n_lines; ++i) {
-        if ((lines[i].str = strtok(NULL, "\r\n")) == NULL) {
-            ERROR_OCCURRED_CALLING(strtok, "returned NULL");
+    if ((strcmp(arg, "-g") == 0) || (strcmp(arg, "--group") == 0)) {
+        *alg = GROUP;
+        return 1;
+    }
 
-            return NULL;
+    if ((strcmp(arg, "-gs") == 0) || (strcmp(arg, "--group-sorted") == 0)) {
+        *alg = GROUP_SORTED;
+        return 1;
+    }
+
+    const char *key_len_str = NULL;
+
+    if (strncmp(arg, "--key-length=", strlen("--key-length=")) == 0) {
+        key_len_str = arg + strlen("--key-length=");
+    } else if (strncmp(arg, "-k", strlen("-k")) == 0) {
+        key_len_str = arg + strlen("-k");
+    }
+
+    if (key_len_str != NULL) {
+        char *key_len_end = NULL;
+
+        unsigned long key_len = strtoul(key_len_str, &key_len_end, 10);
+
+        if ((key_len_end == key_len_str) || (*key_len_end != '\0') || (key_len == 0) || (key_len > MAX_RHYME_KEY_LEN)) {
+            return 0;
         }
 
-        lines[i].str[-1] = '\0';
-        lines[i].len = strlen(lines[i].str);
+        *rhyme_key_len = (size_t) key_len;
+        return 1;
     }
 
-    return lines;
+    return 0;
 }
 
 /*!
- * Reads input file to BUFFER. BUFFER must be freed by caller
+ * Gets the function which does the sorting and output for a sort algorithm
  *
- * @param [in] input_file_name name of the input file
+ * @param [in] alg enum constant which sets the sort algorithm
  *
- * @return 0 in case of success, 1 if the input file was empty, a different non-zero value otherwise
+ * @return pointer to function which does the sorting and output
+ */
+sort_and_output_to_file_wrapper_func_t *get_sort_and_output_to_file(sort_alg alg)
+{
+    switch (alg) {
+    case QUICK:
+        return q_sort_and_output_to_file;
+    case INCREMENTAL:
+        return incremental_q_sort_and_output_to_file;
+    case MULTIKEY:
+        return multikey_q_sort_and_output_to_file;
+    case GROUP:
+        return group_and_output_to_file;
+    case GROUP_SORTED:
+        return group_sort_and_output_to_file;
+    case TREE:
+    default:
+        return tree_sort_and_output_to_file;
+    }
+}
+
+/*!
+ * Runs the sort daemon, which listens on a Unix domain socket and serves sort requests until it gets the "QUIT"
+ * request, avoiding the cost of spawning a process per request.
  *
- * @note Puts '\0' at the beginning of BUFFER for the purpose of dividing strings by '\0'
+ * A request is a single line terminated by '\n' and at most MAX_DAEMON_REQUEST_LEN bytes long, consisting of optional
+ * sort options ("-r", "-q", "-i", "-m", "-g", "-gs", "-k<K>" and their long forms) followed by the input file name,
+ * or by "PAYLOAD <size>" and then size bytes of text in the input file format.
+ * The reply starts with a status line: "OK\n" followed by the sorted output (and the longest common prefixes
+ * after a "LONGEST COMMON PREFIXES" header, if any), "EMPTY\n" if the input was empty, or "ERROR\n"
+ *
+ * @param [in] socket_path path of the socket to listen on
+ *
+ * @return 0 in case of success, a non-zero value otherwise
+ *
+ * @note The output is kept in MEMORY_FILES, so no files are written and requests are served one at a time. A client,
+ * which doesn't send or receive data for DAEMON_CLIENT_TIMEOUT_MS, is dropped, so it can't stall the others
  */
-int read_file_to_buffer(const char *input_file_name)
+int run_sort_daemon(const char *socket_path)
 {
-    assert(input_file_name != NULL);
+    assert(socket_path != NULL);
 
-    HANDLE input_file_handle = CreateFileA(input_file_name, GENERIC_READ, 0, NULL, OPEN_EXISTING, NULL, NULL);
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
 
-    if (input_file_handle == INVALID_HANDLE_VALUE) {
-        ERROR_OCCURRED_CALLING(CreateFileA, "returned INVALID_HANDLE_VALUE");
+    if (strlen(socket_path) >= sizeof(address.sun_path)) {
+        ERROR_OCCURRED_CALLING(run_sort_daemon, "got a socket path which is too long");
 
         return -1;
     }
 
-    DWORD input_file_size = GetFileSize(input_file_handle, NULL);
-
-    if (input_file_size == 0) {
-        return 1;
-    }
-    HANDLE input_file_mapping_handle = CreateFileMappingA(input_file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    strcpy(address.sun_path, socket_path);
 
-    if (input_file_mapping_handle == NULL) {
-        ERROR_OCCURRED_CALLING(CreateFileMappingA, "returned NULL");
+    WSADATA wsa_data = {};
 
-        if (CloseHandle(input_file_handle) == 0) {
-            ERROR_OCCURRED_CALLING(CloseHandle, "returned zero on closing input file handle");
-        }
+    if (WSAStartup(MAKEWORD(2, 2), &wsa_data)) {
+        ERROR_OCCURRED_CALLING(WSAStartup, "returned a non-zero value");
 
         return -1;
     }
 
-    LPVOID input_file_map_view = MapViewOfFile(input_file_mapping_handle, FILE_MAP_READ, 0, 0, 0);
-
-    if (input_file_map_view == NULL) {
-        ERROR_OCCURRED_CALLING(MapViewOfFile, "returned NULL");
+    SOCKET listen_socket = socket(AF_UNIX, SOCK_STREAM, 0);
 
-        if (CloseHandle(input_file_mapping_handle) == 0) {
-            ERROR_OCCURRED_CALLING(CloseHandle, "returned zero on closing input file mapping handle");
-        }
+    if (listen_socket == INVALID_SOCKET) {
+        ERROR_OCCURRED_CALLING(socket, "returned INVALID_SOCKET");
 
-        if (CloseHandle(input_file_handle) == 0) {
-            ERROR_OCCURRED_CALLING(CloseHandle, "returned zero on closing input file handle");
-        }
+        WSACleanup();
 
         return -1;
     }
 
-    if ((BUFFER = (char *) calloc(input_file_size + 2, sizeof(*BUFFER))) == NULL) {
-        ERROR_OCCURRED_CALLING(calloc, "returned NULL");
+    if (remove_stale_socket(socket_path, &address)) {
+        ERROR_OCCURRED_CALLING(remove_stale_socket, "returned a non-zero value");
+
+        closesocket(listen_socket);
+        WSACleanup();
 
         return -1;
     }
 
-    memcpy(BUFFER + 1, input_file_map_view, input_file_size);
+    if ((bind(listen_socket, (const sockaddr *) &address, sizeof(address)) == SOCKET_ERROR) ||
+        (listen(listen_socket, SOMAXCONN) == SOCKET_ERROR)) {
+        ERROR_OCCURRED_CALLING(bind, "or listen returned SOCKET_ERROR");
 
-    int error_flag1 = 0, error_flag2 = 0, error_flag3 = 0;
+        closesocket(listen_socket);
+        WSACleanup();
 
-    if ((error_flag1 = UnmapViewOfFile(input_file_map_view)) == 0) {
-        ERROR_OCCURRED_CALLING(UnmapViewOfFile, "returned zero");
+        return -1;
     }
 
-    if ((error_flag2 = CloseHandle(input_file_mapping_handle)) == 0) {
-        ERROR_OCCURRED_CALLING(CloseHandle, "returned zero on closing input file mapping");
-    }
+    printf("Sort daemon is listening on \"%s\"\n", socket_path);
 
-    if ((error_flag3 = CloseHandle(input_file_handle)) == 0) {
-        ERROR_OCCURRED_CALLING(CloseHandle, "returned zero on closing input file");
-    }
+    USE_MEMORY_FILES = true;
 
-    return !(error_flag1 && error_flag2 && error_flag3);
-}
+    int error_flag = 0;
 
-/*!
- * Counts the number of lines in BUFFER
- *
- * @return the number of lines
- */
-size_t count_lines_in_buffer()
-{
-    assert(BUFFER != NULL);
+    bool stop = false;
 
-    int pre_pre_c = EOF,
-        pre_c     = EOF;
+    while (!stop) {
+        SOCKET client = accept(listen_socket, NULL, NULL);
 
-    size_t n_lines = 0;
+        if (client == INVALID_SOCKET) {
+            ERROR_OCCURRED_CALLING(accept, "returned INVALID_SOCKET");
 
-    const char *reader = BUFFER + 1;
+            error_flag = -1;
 
-    while (*reader) {
-        if ((*reader == '\n') && (pre_c == '\r') && (pre_pre_c != '\n') && (pre_pre_c != EOF)) {
-            ++n_lines;
+            break;
         }
 
-        pre_pre_c = pre_c;
+        DWORD timeout_ms = DAEMON_CLIENT_TIMEOUT_MS;
 
-        pre_c = (unsigned char) *(reader++);
-    }
+        const char *timeout = (const char *) &timeout_ms;
 
-    if ((pre_c != '\n') && (pre_c != EOF) && (pre_pre_c != '\r')) {
-        ++n_lines;
+        if ((setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, timeout, sizeof(timeout_ms)) == SOCKET_ERROR) ||
+            (setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, timeout, sizeof(timeout_ms)) == SOCKET_ERROR)) {
+            ERROR_OCCURRED_CALLING(setsockopt, "returned SOCKET_ERROR on setting client socket timeouts");
+        } else if (serve_sort_daemon_request(client, &stop)) {
+            ERROR_OCCURRED_CALLING(serve_sort_daemon_request, "returned a non-zero value");
+        }
+
+        if (closesocket(client) == SOCKET_ERROR) {
+            ERROR_OCCURRED_CALLING(closesocket, "returned SOCKET_ERROR on closing client socket");
+        }
     }
 
-    return n_lines;
+    USE_MEMORY_FILES = false;
+
+    clear_memory_files(true);
+
+    closesocket(listen_socket);
+    DeleteFileA(socket_path);
+    WSACleanup();
+
+    return error_flag;
 }
 
 /*!
- * Sorts lines using the quick sort algorithm and writes the sorted lines to output file
- *
- * @param [in] lines pointer to array of pointers to line
- * @param [in] n_lines the array size
- * @param [in] line_cmp pointer to the line comparator function
+ * Removes the socket left at the socket path by a daemon which didn't stop properly
  *
- * @return 0 in case of success, a non-zero value otherwise
+ * @param [in] socket_path the socket path
+ * @param [in] address pointer to the socket address
  *
- * @note The output file name is OUTPUT_FILE_NAME
+ * @return 0 if the path is free now, a non-zero value if it's taken by a different file or a running daemon
  */
-int q_sort_and_output_to_file(const line_t *lines, size_t n_lines, comparator_func_t *line_cmp)
+int remove_stale_socket(const char *socket_path, const sockaddr_un *address)
 {
-    assert(lines != NULL);
-    assert(line_cmp != NULL);
+    assert(socket_path != NULL);
+    assert(address != NULL);
 
-    assert(n_lines > 0);
+    WIN32_FIND_DATAA find_data = {};
 
-    line_t *lines_copy = NULL;
+    HANDLE find_handle = FindFirstFileA(socket_path, &find_data);
 
-    if ((lines_copy = (line_t *) calloc(n_lines, sizeof(*lines_copy))) == NULL) {
-        ERROR_OCCURRED_CALLING(calloc, "returned NULL");
+    if (find_handle == INVALID_HANDLE_VALUE) {
+        return 0;
+    }
+
+    FindClose(find_handle);
+
+    if (!(find_data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) ||
+        (find_data.dwReserved0 != IO_REPARSE_TAG_AF_UNIX)) {
+        ERROR_OCCURRED_CALLING(remove_stale_socket, "found a file which isn't a socket at the socket path");
 
         return -1;
     }
 
-    memcpy(lines_copy, lines, n_lines * sizeof(*lines));
+    SOCKET probe_socket = socket(AF_UNIX, SOCK_STREAM, 0);
 
-    qsort(lines_copy, n_lines, sizeof(*lines), line_cmp);
+    if (probe_socket == INVALID_SOCKET) {
+        ERROR_OCCURRED_CALLING(socket, "returned INVALID_SOCKET");
 
-    if (write_lines_to_file(lines_copy, n_lines, "w")) {
-        ERROR_OCCURRED_CALLING(write_lines_to_file, "returned a non-zero value");
+        return -1;
+    }
 
-        FREE(lines_copy);
+    bool is_alive = (connect(probe_socket, (const sockaddr *) address, sizeof(*address)) != SOCKET_ERROR);
+
+    closesocket(probe_socket);
+
+    if (is_alive) {
+        ERROR_OCCURRED_CALLING(remove_stale_socket, "found a running daemon at the socket path");
 
         return -1;
     }
 
-    FREE(lines_copy);
+    if (DeleteFileA(socket_path) == 0) {
+        ERROR_OCCURRED_CALLING(DeleteFileA, "returned zero on deleting the stale socket");
+
+        return -1;
+    }
 
     return 0;
 }
 
 /*!
- * Writes lines to the output file
- *
- * @param [in] lines pointer to an array of lines
- * @param [in] n_lines the array size
- * @param [in] open_mode the mode in which the output file is opened
+ * Serves a single sort daemon request
  *
- * @return 0 in case of success, otherwise a non-zero value
+ * @param [in] client the client socket
+ * @param [out] stop pointer to flag, which is set if the daemon must stop
  *
- * @note The output file name is OUTPUT_FILE_NAME
+ * @return 0 in case of success, a non-zero value otherwise
  */
-int write_lines_to_file(const line_t *lines, size_t n_lines, const char *open_mode)
+int serve_sort_daemon_request(SOCKET client, bool *stop)
 {
-    FILE *output = NULL;
-
-    if ((output = fopen(OUTPUT_FILE_NAME, open_mode)) == NULL) {
-        ERROR_OCCURRED_CALLING(fopen, "returned NULL");
+    assert(stop != NULL);
 
-        return -1;
-    }
+    char request[MAX_DAEMON_REQUEST_LEN + 1] = {};
+    size_t request_len = 0;
 
-    if (strcmp(open_mode, "a") == 0) {
-        fprintf(output, "\nORIGINAL TEXT\n\n");
-    }
+    while ((request_len < MAX_DAEMON_REQUEST_LEN) && (memchr(request, '\n', request_len) == NULL)) {
+        int n_received = recv(client, request + request_len, (int) (MAX_DAEMON_REQUEST_LEN - request_len), 0);
 
-    for (size_t i = 0; i < n_lines; ++i) {
-        const char *str = lines[i].str;
+        if (n_received == SOCKET_ERROR) {
+            ERROR_OCCURRED_CALLING(recv, "returned SOCKET_ERROR");
 
-        while (isspace(*str)) {
-            ++str;
+            return -1;
+        }
+
+        if (n_received == 0) {
+            break;
+        }
+
+        request_len += (size_t) n_received;
+    }
+
+    char *request_end = (char *) memchr(request, '\n', request_len);
+
+    /* A request, which is too long or isn't terminated, is rejected, so that its truncated file name isn't sorted */
+    if (request_end == NULL) {
+        return send_to_client(client, "ERROR\n", strlen("ERROR\n"));
+    }
+
+    const char *payload = request_end + 1;
+    size_t received_payload_size = request_len - (size_t) (payload - request);
+
+    request[strcspn(request, "\r\n")] = '\0';
+
+    if (strcmp(request, "QUIT") == 0) {
+        *stop = true;
+
+        return send_to_client(client, "OK\n", strlen("OK\n"));
+    }
+
+    sort_mode mode = DIRECT;
+
+    sort_alg alg = TREE;
+
+    RHYME_KEY_LEN = DEFAULT_RHYME_KEY_LEN;
+
+    char *input_file_name = request;
+
+    while (*input_file_name == '-') {
+        char *option_end = input_file_name + strcspn(input_file_name, " ");
+
+        if (*option_end == '\0') {
+            break;
+        }
+
+        *option_end = '\0';
+
+        if (!parse_sort_option(input_file_name, &mode, &alg, &RHYME_KEY_LEN)) {
+            return send_to_client(client, "ERROR\n", strlen("ERROR\n"));
+        }
+
+        input_file_name = option_end + 1;
+    }
+
+    clear_memory_files(false);
+
+    int error_code = 0;
+
+    if (strncmp(input_file_name, "PAYLOAD ", strlen("PAYLOAD ")) == 0) {
+        char *payload_size_end = NULL;
+
+        unsigned long long payload_size = strtoull(input_file_name + strlen("PAYLOAD "), &payload_size_end, 10);
+
+        if ((*payload_size_end != '\0') || (payload_size > MAX_DAEMON_PAYLOAD_SIZE)) {
+            return send_to_client(client, "ERROR\n", strlen("ERROR\n"));
+        }
+
+        error_code = read_payload_to_buffer(client, payload, received_payload_size, (size_t) payload_size);
+
+        if (error_code == 0) {
+            error_code = sort_buffer_and_output_to_file(mode, get_sort_and_output_to_file(alg));
+        }
+    } else {
+        error_code = eugene_onegin_sort(input_file_name, mode, get_sort_and_output_to_file(alg));
+    }
+
+    switch (error_code) {
+    case 0:
+        return send_sort_reply(client);
+
+    case 1:
+        return send_to_client(client, "EMPTY\n", strlen("EMPTY\n"));
+
+    default:
+        return send_to_client(client, "ERROR\n", strlen("ERROR\n"));
+    }
+}
+
+/*!
+ * Reads the inline payload of a sort daemon request to BUFFER. BUFFER must be freed by caller
+ *
+ * @param [in] client the client socket
+ * @param [in] received pointer to the part of the payload which was received along with the request line
+ * @param [in] received_size the size of that part
+ * @param [in] payload_size the payload size
+ *
+ * @return 0 in case of success, 1 if the payload was empty, a different non-zero value otherwise
+ *
+ * @note Puts '\0' at the beginning of BUFFER for the purpose of dividing strings by '\0'
+ */
+int read_payload_to_buffer(SOCKET client, const char *received, size_t received_size, size_t payload_size)
+{
+    assert(received != NULL);
+
+    if (received_size > payload_size) {
+        ERROR_OCCURRED_CALLING(read_payload_to_buffer, "received more data than the payload size");
+
+        return -1;
+    }
+
+    if (payload_size == 0) {
+        return 1;
+    }
+
+    if ((BUFFER = (char *) calloc(payload_size + 2, sizeof(*BUFFER))) == NULL) {
+        ERROR_OCCURRED_CALLING(calloc, "returned NULL");
+
+        return -1;
+    }
+
+    memcpy(BUFFER + 1, received, received_size);
+
+    while (received_size < payload_size) {
+        int n_received = recv(client, BUFFER + 1 + received_size, (int) (payload_size - received_size), 0);
+
+        if ((n_received == SOCKET_ERROR) || (n_received == 0)) {
+            ERROR_OCCURRED_CALLING(recv, "returned SOCKET_ERROR or the payload was cut short");
+
+            FREE(BUFFER);
+
+            return -1;
+        }
+
+        received_size += (size_t) n_received;
+    }
+
+    return 0;
+}
+
+/*!
+ * Sends data to the client, retrying partial sends
+ *
+ * @param [in] client the client socket
+ * @param [in] data pointer to data
+ * @param [in] size the data size
+ *
+ * @return 0 in case of success, a non-zero value otherwise
+ */
+int send_to_client(SOCKET client, const char *data, size_t size)
+{
+    assert(data != NULL);
+
+    while (size > 0) {
+        int n_sent = send(client, data, (int) size, 0);
+
+        if (n_sent == SOCKET_ERROR) {
+            ERROR_OCCURRED_CALLING(send, "returned SOCKET_ERROR");
+
+            return -1;
+        }
+
+        data += n_sent;
+        size -= (size_t) n_sent;
+    }
+
+    return 0;
+}
+
+/*!
+ * Sends the reply to a successfully served sort request: the "OK" status line, the sorted output and the longest
+ * common prefixes, if the sort algorithm wrote them
+ *
+ * @param [in] client the client socket
+ *
+ * @return 0 in case of success, a non-zero value otherwise
+ */
+int send_sort_reply(SOCKET client)
+{
+    const memory_file_t *output_file = get_memory_file(OUTPUT_FILE_NAME),
+                        *lcp_file    = get_memory_file(LCP_FILE_NAME);
+
+    assert(output_file != NULL);
+    assert(lcp_file != NULL);
+
+    if (send_to_client(client, "OK\n", strlen("OK\n")) ||
+        ((output_file->size != 0) && send_to_client(client, output_file->data, output_file->size))) {
+        ERROR_OCCURRED_CALLING(send_to_client, "returned a non-zero value");
+
+        return -1;
+    }
+
+    if (lcp_file->size == 0) {
+        return 0;
+    }
+
+    if (send_to_client(client, "\nLONGEST COMMON PREFIXES\n\n", strlen("\nLONGEST COMMON PREFIXES\n\n")) ||
+        send_to_client(client, lcp_file->data, lcp_file->size)) {
+        ERROR_OCCURRED_CALLING(send_to_client, "returned a non-zero value");
+
+        return -1;
+    }
+
+    return 0;
+}
+
+/*!
+ * Opens an output: the file with the given name or, if USE_MEMORY_FILES is set, the memory file with that name
+ *
+ * @param [out] output pointer to output
+ * @param [in] file_name name of the file
+ * @param [in] open_mode the mode in which the file is opened ("w" or "a")
+ *
+ * @return 0 in case of success, a non-zero value otherwise
+ */
+int open_output(output_t *output, const char *file_name, const char *open_mode)
+{
+    assert(output != NULL);
+    assert(file_name != NULL);
+    assert(open_mode != NULL);
+
+    output->file        = NULL;
+    output->memory_file = NULL;
+    output->position    = 0;
+
+    if (USE_MEMORY_FILES) {
+        if ((output->memory_file = get_memory_file(file_name)) == NULL) {
+            ERROR_OCCURRED_CALLING(get_memory_file, "returned NULL");
+
+            return -1;
+        }
+
+        if (strcmp(open_mode, "a") != 0) {
+            output->memory_file->size = 0;
+        }
+
+        return 0;
+    }
+
+    if ((output->file = fopen(file_name, open_mode)) == NULL) {
+        ERROR_OCCURRED_CALLING(fopen, "returned NULL");
+
+        return -1;
+    }
+
+    if (setvbuf(output->file, NULL, _IOFBF, OUTPUT_BUFFER_SIZE)) {
+        ERROR_OCCURRED_CALLING(setvbuf, "returned a non-zero value");
+    }
+
+    return 0;
+}
+
+/*!
+ * Writes data to an output
+ *
+ * @param [in, out] output pointer to output
+ * @param [in] data pointer to data
+ * @param [in] size the data size
+ *
+ * @return 0 in case of success, a non-zero value otherwise
+ */
+int write_to_output(output_t *output, const char *data, size_t size)
+{
+    assert(output != NULL);
+    assert(data != NULL);
+
+    if (output->file != NULL) {
+        if (fwrite(data, sizeof(*data), size, output->file) != size) {
+            ERROR_OCCURRED_CALLING(fwrite, "wrote less characters than requested");
+
+            return -1;
+        }
+    } else {
+        memory_file_t *memory_file = output->memory_file;
+
+        assert(memory_file != NULL);
+
+        if (memory_file->size + size > memory_file->capacity) {
+            size_t capacity = (memory_file->capacity != 0) ? memory_file->capacity : OUTPUT_BUFFER_SIZE;
+
+            while (capacity < memory_file->size + size) {
+                capacity *= 2;
+            }
+
+            char *data_copy = (char *) realloc(memory_file->data, capacity);
+
+            if (data_copy == NULL) {
+                ERROR_OCCURRED_CALLING(realloc, "returned NULL");
+
+                return -1;
+            }
+
+            memory_file->data     = data_copy;
+            memory_file->capacity = capacity;
+        }
+
+        memcpy(memory_file->data + memory_file->size, data, size);
+        memory_file->size += size;
+    }
+
+    output->position += size;
+
+    return 0;
+}
+
+/*!
+ * Flushes an output, so that the data written so far can be read by others
+ *
+ * @param [in, out] output pointer to output
+ *
+ * @return 0 in case of success, a non-zero value otherwise
+ */
+int flush_output(output_t *output)
+{
+    assert(output != NULL);
+
+    if ((output->file != NULL) && fflush(output->file)) {
+        ERROR_OCCURRED_CALLING(fflush, "returned a non-zero value");
+
+        return -1;
+    }
+
+    return 0;
+}
+
+/*!
+ * Closes an output. The contents of a memory file stay in it until the memory files are cleared
+ *
+ * @param [in, out] output pointer to output
+ *
+ * @return 0 in case of success, a non-zero value otherwise
+ */
+int close_output(output_t *output)
+{
+    assert(output != NULL);
+
+    FILE *file = output->file;
+
+    output->file        = NULL;
+    output->memory_file = NULL;
+
+    if ((file != NULL) && fclose(file)) {
+        ERROR_OCCURRED_CALLING(fclose, "returned a non-zero value");
+
+        return -1;
+    }
+
+    return 0;
+}
+
+/*!
+ * Gets the memory file with the given name
+ *
+ * @param [in] file_name name of the file
+ *
+ * @return pointer to the memory file, NULL if there is no memory file with that name
+ */
+memory_file_t *get_memory_file(const char *file_name)
+{
+    assert(file_name != NULL);
+
+    for (size_t i = 0; i < sizeof(MEMORY_FILES) / sizeof(*MEMORY_FILES); ++i) {
+        if (strcmp(MEMORY_FILES[i].name, file_name) == 0) {
+            return &MEMORY_FILES[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*!
+ * Empties the memory files
+ *
+ * @param [in] release whether the memory of the files is freed too
+ */
+void clear_memory_files(bool release)
+{
+    for (size_t i = 0; i < sizeof(MEMORY_FILES) / sizeof(*MEMORY_FILES); ++i) {
+        MEMORY_FILES[i].size = 0;
+
+        if (release) {
+            FREE(MEMORY_FILES[i].data);
+            MEMORY_FILES[i].capacity = 0;
+        }
+    }
+}
+
+/*!
+ * Gets lines from BUFFER by tokenizing it
+ *
+ * @param [out] n_lines number of lines in BUFFER
+ *
+ * @return pointer to an array of retrieved lines
+ *
+ * @note Returns NULL in case of failure
+ */
+line_t *get_lines_from_buffer(size_t n_lines)
+{
+    line_t *lines = (line_t *) calloc(n_lines + 1, sizeof(*lines));
+
+    if (lines == NULL) {
+        ERROR_OCCURRED_CALLING(calloc, "returned NULL");
+
+        return NULL;
+    }
+
+    if ((lines[0].str = strtok(BUFFER + 1, "\r\n")) == NULL) {
+        ERROR_OCCURRED_CALLING(strtok, "returned NULL");
+
+        return NULL;
+    }
+    lines[0].str[-1] = '\0';
+    lines[0].len = strlen(lines[0].str);
+
+    for (size_t i = 1; i < n_lines; ++i) {
+        if ((lines[i].str = strtok(NULL, "\r\n")) == NULL) {
+            ERROR_OCCURRED_CALLING(strtok, "returned NULL");
+
+            return NULL;
+        }
+
+        lines[i].str[-1] = '\0';
+        lines[i].len = strlen(lines[i].str);
+    }
+
+    return lines;
+}
+
+/*!
+ * Reads input file to BUFFER. BUFFER must be freed by caller
+ *
+ * @param [in] input_file_name name of the input file
+ *
+ * @return 0 in case of success, 1 if the input file was empty, a different non-zero value otherwise
+ *
+ * @note Puts '\0' at the beginning of BUFFER for the purpose of dividing strings by '\0'
+ */
+int read_file_to_buffer(const char *input_file_name)
+{
+    assert(input_file_name != NULL);
+
+    HANDLE input_file_handle = CreateFileA(input_file_name, GENERIC_READ, 0, NULL, OPEN_EXISTING, NULL, NULL);
+
+    if (input_file_handle == INVALID_HANDLE_VALUE) {
+        ERROR_OCCURRED_CALLING(CreateFileA, "returned INVALID_HANDLE_VALUE");
+
+        return -1;
+    }
+
+    DWORD input_file_size = GetFileSize(input_file_handle, NULL);
+
+    if (input_file_size == 0) {
+        if (CloseHandle(input_file_handle) == 0) {
+            ERROR_OCCURRED_CALLING(CloseHandle, "returned zero on closing input file handle");
+        }
+
+        return 1;
+    }
+
+    HANDLE input_file_mapping_handle = CreateFileMappingA(input_file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+
+    if (input_file_mapping_handle == NULL) {
+        ERROR_OCCURRED_CALLING(CreateFileMappingA, "returned NULL");
+
+        if (CloseHandle(input_file_handle) == 0) {
+            ERROR_OCCURRED_CALLING(CloseHandle, "returned zero on closing input file handle");
+        }
+
+        return -1;
+    }
+
+    LPVOID input_file_map_view = MapViewOfFile(input_file_mapping_handle, FILE_MAP_READ, 0, 0, 0);
+
+    if (input_file_map_view == NULL) {
+        ERROR_OCCURRED_CALLING(MapViewOfFile, "returned NULL");
+
+        if (CloseHandle(input_file_mapping_handle) == 0) {
+            ERROR_OCCURRED_CALLING(CloseHandle, "returned zero on closing input file mapping handle");
+        }
+
+        if (CloseHandle(input_file_handle) == 0) {
+            ERROR_OCCURRED_CALLING(CloseHandle, "returned zero on closing input file handle");
+        }
+
+        return -1;
+    }
+
+    if ((BUFFER = (char *) calloc(input_file_size + 2, sizeof(*BUFFER))) == NULL) {
+        ERROR_OCCURRED_CALLING(calloc, "returned NULL");
+    } else {
+        memcpy(BUFFER + 1, input_file_map_view, input_file_size);
+    }
+
+    int error_flag1 = 0, error_flag2 = 0, error_flag3 = 0;
+
+    if ((error_flag1 = UnmapViewOfFile(input_file_map_view)) == 0) {
+        ERROR_OCCURRED_CALLING(UnmapViewOfFile, "returned zero");
+    }
+
+    if ((error_flag2 = CloseHandle(input_file_mapping_handle)) == 0) {
+        ERROR_OCCURRED_CALLING(CloseHandle, "returned zero on closing input file mapping");
+    }
+
+    if ((error_flag3 = CloseHandle(input_file_handle)) == 0) {
+        ERROR_OCCURRED_CALLING(CloseHandle, "returned zero on closing input file");
+    }
+
+    if (BUFFER == NULL) {
+        return -1;
+    }
+
+    return !(error_flag1 && error_flag2 && error_flag3);
+}
+
+/*!
+ * Counts the number of lines in BUFFER
+ *
+ * @return the number of lines
+ */
+size_t count_lines_in_buffer()
+{
+    assert(BUFFER != NULL);
+
+    int pre_pre_c = EOF,
+        pre_c     = EOF;
+
+    size_t n_lines = 0;
+
+    const char *reader = BUFFER + 1;
+
+    while (*reader) {
+        if ((*reader == '\n') && (pre_c == '\r') && (pre_pre_c != '\n') && (pre_pre_c != EOF)) {
+            ++n_lines;
+        }
+
+        pre_pre_c = pre_c;
+
+        pre_c = (unsigned char) *(reader++);
+    }
+
+    if ((pre_c != '\n') && (pre_c != EOF) && (pre_pre_c != '\r')) {
+        ++n_lines;
+    }
+
+    return n_lines;
+}
+
+/*!
+ * Sorts lines using the quick sort algorithm and writes the sorted lines to output file
+ *
+ * @param [in] lines pointer to array of pointers to line
+ * @param [in] n_lines the array size
+ * @param [in] line_cmp pointer to the line comparator function
+ *
+ * @return 0 in case of success, a non-zero value otherwise
+ *
+ * @note The output file name is OUTPUT_FILE_NAME
+ */
+int q_sort_and_output_to_file(const line_t *lines, size_t n_lines, comparator_func_t *line_cmp)
+{
+    assert(lines != NULL);
+    assert(line_cmp != NULL);
+
+    assert(n_lines > 0);
+
+    line_t *lines_copy = NULL;
+
+    if ((lines_copy = (line_t *) calloc(n_lines, sizeof(*lines_copy))) == NULL) {
+        ERROR_OCCURRED_CALLING(calloc, "returned NULL");
+
+        return -1;
+    }
+
+    memcpy(lines_copy, lines, n_lines * sizeof(*lines));
+
+    qsort(lines_copy, n_lines, sizeof(*lines), line_cmp);
+
+    if (write_lines_to_file(lines_copy, n_lines, "w")) {
+        ERROR_OCCURRED_CALLING(write_lines_to_file, "returned a non-zero value");
+
+        FREE(lines_copy);
+
+        return -1;
+    }
+
+    FREE(lines_copy);
+
+    return 0;
+}
+
+/*!
+ * Writes lines to the output file
+ *
+ * @param [in] lines pointer to an array of lines
+ * @param [in] n_lines the array size
+ * @param [in] open_mode the mode in which the output file is opened
+ *
+ * @return 0 in case of success, otherwise a non-zero value
+ *
+ * @note The output file name is OUTPUT_FILE_NAME
+ */
+int write_lines_to_file(const line_t *lines, size_t n_lines, const char *open_mode)
+{
+    output_t output = {};
+
+    if (open_output(&output, OUTPUT_FILE_NAME, open_mode)) {
+        ERROR_OCCURRED_CALLING(open_output, "returned a non-zero value");
+
+        return -1;
+    }
+
+    if (strcmp(open_mode, "a") == 0) {
+        write_to_output(&output, "\nORIGINAL TEXT\n\n", strlen("\nORIGINAL TEXT\n\n"));
+    }
+
+    for (size_t i = 0; i < n_lines; ++i) {
+        if (write_line_to_file(&output, &lines[i])) {
+            ERROR_OCCURRED_CALLING(write_line_to_file, "returned a non-zero value");
+
+            close_output(&output);
+
+            return -1;
+        }
+    }
+
+    if (close_output(&output)) {
+        ERROR_OCCURRED_CALLING(close_output, "returned a non-zero value");
+
+        return -1;
+    }
+
+    return 0;
+}
+
+/*!
+ * Writes a line to the output file, skipping its leading whitespace. Lines which don't look like poem lines
+ * are skipped
+ *
+ * @param [in, out] output pointer to output
+ * @param [in] line pointer to line
+ *
+ * @return 0 in case of success, otherwise a non-zero value
+ *
+ * @note The line is written as a block instead of with fprintf, since its length is already known
+ */
+int write_line_to_file(output_t *output, const line_t *line)
+{
+    assert(output != NULL);
+    assert(line != NULL);
+
+    const char *str = get_poem_line(line);
+
+    if (str == NULL) {
+        return 0;
+    }
+
+    size_t len = line->len - (size_t) (str - line->str);
+
+    if (write_to_output(output, str, len) || write_to_output(output, "\n", 1)) {
+        ERROR_OCCURRED_CALLING(write_to_output, "returned a non-zero value");
+
+        return -1;
+    }
+
+    return 0;
+}
+
+/*!
+ * Gets a poem line from a line by skipping its leading whitespace
+ *
+ * @param [in] line pointer to line
+ *
+ * @return pointer to the first non-whitespace character of the line
+ *
+ * @note Returns NULL if the line doesn't look like a poem line (the second non-whitespace character isn't a
+ * lowercase letter)
+ */
+const char *get_poem_line(const line_t *line)
+{
+    assert(line != NULL);
+
+    const char *str = line->str;
+
+    while (isspace((unsigned char) *str)) {
+        ++str;
+    }
+
+    return (str[0] && islower((unsigned char) str[1])) ? str : NULL;
+}
+
+/*!
+ * Sorts lines using the incremental quick sort algorithm and writes each line to output file as soon as its
+ * position is known, so that the first sorted lines appear before the whole sort is done. The total cost stays
+ * O(n log n) on average.
+ *
+ * The stack holds, in decreasing order, the positions of lines which are known to be in their final places: the
+ * lines between the current position and the top of the stack aren't sorted yet. They are partitioned until the
+ * line at the current position is in its final place, then it's written out
+ *
+ * @param [in] lines pointer to array of pointers to line
+ * @param [in] n_lines the array size
+ * @param [in] line_cmp pointer to the line comparator function
+ *
+ * @return 0 in case of success, a non-zero value otherwise
+ *
+ * @note The output file name is OUTPUT_FILE_NAME
+ */
+int incremental_q_sort_and_output_to_file(const line_t *lines, size_t n_lines, comparator_func_t *line_cmp)
+{
+    assert(lines != NULL);
+    assert(line_cmp != NULL);
+
+    assert(n_lines > 0);
+
+    line_t *lines_copy = (line_t *) calloc(n_lines, sizeof(*lines_copy));
+
+    if (lines_copy == NULL) {
+        ERROR_OCCURRED_CALLING(calloc, "returned NULL");
+
+        return -1;
+    }
+
+    memcpy(lines_copy, lines, n_lines * sizeof(*lines));
+
+    size_t *final_positions = (size_t *) calloc(n_lines + 1, sizeof(*final_positions));
+
+    if (final_positions == NULL) {
+        ERROR_OCCURRED_CALLING(calloc, "returned NULL");
+
+        FREE(lines_copy);
+
+        return -1;
+    }
+
+    output_t output = {};
+
+    if (open_output(&output, OUTPUT_FILE_NAME, "w")) {
+        ERROR_OCCURRED_CALLING(open_output, "returned a non-zero value");
+
+        FREE(final_positions);
+        FREE(lines_copy);
+
+        return -1;
+    }
+
+    int error_flag = 0;
+
+    size_t n_final_positions = 0;
+    final_positions[n_final_positions++] = n_lines;
+
+    for (size_t i = 0; (i < n_lines) && !error_flag; ++i) {
+        while (final_positions[n_final_positions - 1] > i) {
+            size_t end = final_positions[n_final_positions - 1],
+                   equal_begin = 0, equal_end = 0;
+
+            partition_lines(lines_copy, i, end, line_cmp, &equal_begin, &equal_end);
+
+            for (size_t position = equal_end; position > equal_begin; --position) {
+                final_positions[n_final_positions++] = position - 1;
+            }
+        }
+
+        --n_final_positions;
+
+        if (write_line_to_file(&output, &lines_copy[i])) {
+            ERROR_OCCURRED_CALLING(write_line_to_file, "returned a non-zero value");
+
+            error_flag = -1;
+        }
+
+        if (!error_flag && ((i + 1) % INCREMENTAL_FLUSH_PERIOD == 0) && flush_output(&output)) {
+            ERROR_OCCURRED_CALLING(flush_output, "returned a non-zero value");
+
+            error_flag = -1;
+        }
+    }
+
+    if (close_output(&output)) {
+        ERROR_OCCURRED_CALLING(close_output, "returned a non-zero value");
+
+        error_flag = -1;
+    }
+
+    FREE(final_positions);
+    FREE(lines_copy);
+
+    return error_flag;
+}
+
+/*!
+ * Partitions lines in range [begin, end) into three parts: lines less than, equal to and greater than the pivot,
+ * which is the median of the first, the middle and the last lines
+ *
+ * @param [in, out] lines pointer to array of lines
+ * @param [in] begin the range beginning
+ * @param [in] end the range end
+ * @param [in] line_cmp pointer to the line comparator function
+ * @param [out] equal_begin pointer to the beginning of lines equal to the pivot
+ * @param [out] equal_end pointer to the end of lines equal to the pivot
+ *
+ * @note Lines equal to the pivot are never empty, since the pivot itself is among them
+ */
+void partition_lines(line_t *lines, size_t begin, size_t end, comparator_func_t *line_cmp,
+                     size_t *equal_begin, size_t *equal_end)
+{
+    assert(lines != NULL);
+    assert(line_cmp != NULL);
+    assert(equal_begin != NULL);
+    assert(equal_end != NULL);
+
+    assert(begin < end);
+
+    const line_t *first  = &lines[begin],
+                 *middle = &lines[begin + (end - begin) / 2],
+                 *last   = &lines[end - 1];
+
+    const line_t *median = NULL;
+
+    if ((*line_cmp)(first, middle) < 0) {
+        median = ((*line_cmp)(middle, last) < 0) ? middle : (((*line_cmp)(first, last) < 0) ? last : first);
+    } else {
+        median = ((*line_cmp)(first, last) < 0) ? first : (((*line_cmp)(middle, last) < 0) ? last : middle);
+    }
+
+    line_t pivot = *median;
+
+    size_t less = begin, current = begin, greater = end;
+
+    while (current < greater) {
+        int cmp_result = (*line_cmp)(&lines[current], &pivot);
+
+        if (cmp_result < 0) {
+            line_t tmp = lines[less];
+            lines[less++] = lines[current];
+            lines[current++] = tmp;
+        } else if (cmp_result > 0) {
+            line_t tmp = lines[--greater];
+            lines[greater] = lines[current];
+            lines[current] = tmp;
+        } else {
+            ++current;
+        }
+    }
+
+    *equal_begin = less;
+    *equal_end   = greater;
+}
+
+/*!
+ * Sorts lines using the multikey quick sort algorithm and writes the sorted lines to output file. Unlike the
+ * comparator based sorts, it never re-compares common prefixes of lines, so each character is examined close to
+ * once. The longest common prefixes of adjacent lines, which it gets as a by-product, are written to LCP_FILE_NAME
+ *
+ * @param [in] lines pointer to array of pointers to line
+ * @param [in] n_lines the array size
+ * @param [in] line_cmp pointer to the line comparator function, which defines the order of processing characters
+ *
+ * @return 0 in case of success, a non-zero value otherwise
+ *
+ * @note The output file name is OUTPUT_FILE_NAME
+ */
+int multikey_q_sort_and_output_to_file(const line_t *lines, size_t n_lines, comparator_func_t *line_cmp)
+{
+    assert(lines != NULL);
+    assert(line_cmp != NULL);
+
+    assert(n_lines > 0);
+
+    sort_key_t *keys = (sort_key_t *) calloc(n_lines, sizeof(*keys));
+
+    if (keys == NULL) {
+        ERROR_OCCURRED_CALLING(calloc, "returned NULL");
+
+        return -1;
+    }
+
+    unsigned char *keys_buffer = get_sort_keys(lines, n_lines, line_cmp == line_cmp_reversed, keys);
+
+    if (keys_buffer == NULL) {
+        ERROR_OCCURRED_CALLING(get_sort_keys, "returned NULL");
+
+        FREE(keys);
+
+        return -1;
+    }
+
+    size_t *lcps = (size_t *) calloc(n_lines, sizeof(*lcps));
+
+    if (lcps == NULL) {
+        ERROR_OCCURRED_CALLING(calloc, "returned NULL");
+
+        FREE(keys_buffer);
+        FREE(keys);
+
+        return -1;
+    }
+
+    multikey_q_sort(keys, n_lines, 0, lcps);
+
+    int error_flag = write_lcps_to_file(keys, lcps, n_lines);
+
+    if (error_flag) {
+        ERROR_OCCURRED_CALLING(write_lcps_to_file, "returned a non-zero value");
+    }
+
+    FREE(lcps);
+    FREE(keys_buffer);
+
+    line_t *sorted_lines = NULL;
+
+    if ((sorted_lines = (line_t *) calloc(n_lines, sizeof(*sorted_lines))) == NULL) {
+        ERROR_OCCURRED_CALLING(calloc, "returned NULL");
+
+        FREE(keys);
+
+        return -1;
+    }
+
+    for (size_t i = 0; i < n_lines; ++i) {
+        sorted_lines[i] = keys[i].line;
+    }
+
+    FREE(keys);
+
+    if (write_lines_to_file(sorted_lines, n_lines, "w")) {
+        ERROR_OCCURRED_CALLING(write_lines_to_file, "returned a non-zero value");
+
+        error_flag = -1;
+    }
+
+    FREE(sorted_lines);
+
+    return error_flag;
+}
+
+/*!
+ * Gets sort keys of lines. The keys are stored in a single buffer, which must be freed by caller
+ *
+ * @param [in] lines pointer to array of pointers to line
+ * @param [in] n_lines the array size
+ * @param [in] reversed true if characters of lines are processed in reversed order
+ * @param [out] keys pointer to array of n_lines sort keys
+ *
+ * @return pointer to the keys buffer
+ *
+ * @note Returns NULL in case of failure
+ */
+unsigned char *get_sort_keys(const line_t *lines, size_t n_lines, bool reversed, sort_key_t *keys)
+{
+    assert(lines != NULL);
+    assert(keys != NULL);
+
+    size_t keys_buffer_size = 0;
+
+    for (size_t i = 0; i < n_lines; ++i) {
+        keys_buffer_size += lines[i].len + 1;
+    }
+
+    unsigned char *keys_buffer = (unsigned char *) calloc(keys_buffer_size, sizeof(*keys_buffer));
+
+    if (keys_buffer == NULL) {
+        ERROR_OCCURRED_CALLING(calloc, "returned NULL");
+
+        return NULL;
+    }
+
+    unsigned char *writer = keys_buffer;
+
+    for (size_t i = 0; i < n_lines; ++i) {
+        keys[i].key  = writer;
+        keys[i].line = lines[i];
+
+        for (size_t j = 0; j < lines[i].len; ++j) {
+            char ch = lines[i].str[reversed ? lines[i].len - 1 - j : j];
+
+            if (is_alpha(ch)) {
+                *(writer++) = (unsigned char) to_lower(ch);
+            }
         }
 
-        if (str[0] && islower(str[1])) {
-            if (fprintf(output, "%s\n", str) < 0) {
-                ERROR_OCCURRED_CALLING(fprintf, "returned negative value");
+        *(writer++) = '\0';
+    }
 
-                if (fclose(output)) {
-                    ERROR_OCCURRED_CALLING(fclose, "returned a non-zero value");
-                }
+    return keys_buffer;
+}
 
-                return -1;
+/*!
+ * Recursively sorts keys using the multikey quick sort algorithm, starting from the character at depth, and saves
+ * the longest common prefixes of adjacent keys
+ *
+ * @param [in, out] keys pointer to array of sort keys, which have a common prefix of length depth
+ * @param [in] n_keys the array size
+ * @param [in] depth the common prefix length
+ * @param [out] lcps pointer to array of longest common prefixes, lcps[i] is set for keys[i - 1] and keys[i]
+ *
+ * @note lcps[0] is left for the caller to set
+ */
+void multikey_q_sort(sort_key_t *keys, size_t n_keys, size_t depth, size_t *lcps)
+{
+    assert(keys != NULL);
+    assert(lcps != NULL);
+
+    while (n_keys >= MULTIKEY_INSERTION_SORT_THRESHOLD) {
+        unsigned char pivot = keys[n_keys / 2].key[depth];
+
+        size_t less = 0, current = 0, greater = n_keys;
+
+        while (current < greater) {
+            unsigned char ch = keys[current].key[depth];
+
+            if (ch < pivot) {
+                sort_key_t tmp = keys[less];
+                keys[less++] = keys[current];
+                keys[current++] = tmp;
+            } else if (ch > pivot) {
+                sort_key_t tmp = keys[--greater];
+                keys[greater] = keys[current];
+                keys[current] = tmp;
+            } else {
+                ++current;
+            }
+        }
+
+        multikey_q_sort(keys, less, depth, lcps);
+        multikey_q_sort(keys + greater, n_keys - greater, depth, lcps + greater);
+
+        if (less > 0) {
+            lcps[less] = depth;
+        }
+
+        if (greater < n_keys) {
+            lcps[greater] = depth;
+        }
+
+        if (pivot == '\0') {
+            for (size_t i = less + 1; i < greater; ++i) {
+                lcps[i] = depth;
             }
+
+            return;
         }
+
+        keys   += less;
+        lcps   += less;
+        n_keys  = greater - less;
+
+        ++depth;
     }
 
-    if (fclose(output)) {
-        ERROR_OCCURRED_CALLING(fclose, "returned a non-zero value");
+    for (size_t i = 1; i < n_keys; ++i) {
+        for (size_t j = i; (j > 0) && (strcmp((const char *) keys[j - 1].key + depth,
+                                              (const char *) keys[j].key + depth) > 0); --j) {
+            sort_key_t tmp = keys[j - 1];
+            keys[j - 1] = keys[j];
+            keys[j] = tmp;
+        }
+    }
+
+    for (size_t i = 1; i < n_keys; ++i) {
+        size_t lcp = depth;
+
+        while (keys[i - 1].key[lcp] && (keys[i - 1].key[lcp] == keys[i].key[lcp])) {
+            ++lcp;
+        }
+
+        lcps[i] = lcp;
+    }
+}
+
+/*!
+ * Writes the longest common prefixes of adjacent sorted lines to LCP_FILE_NAME, one "<lcp> <line>" pair per line.
+ * Only lines which are written to the output file are written, and the prefix of a line is computed relative to
+ * the previously written line
+ *
+ * @param [in] keys pointer to array of sorted keys
+ * @param [in] lcps pointer to array of longest common prefixes of adjacent keys
+ * @param [in] n_keys the arrays size
+ *
+ * @return 0 in case of success, a non-zero value otherwise
+ */
+int write_lcps_to_file(const sort_key_t *keys, const size_t *lcps, size_t n_keys)
+{
+    assert(keys != NULL);
+    assert(lcps != NULL);
+
+    output_t output = {};
+
+    if (open_output(&output, LCP_FILE_NAME, "w")) {
+        ERROR_OCCURRED_CALLING(open_output, "returned a non-zero value");
 
         return -1;
     }
 
-    return 0;
+    int error_flag = 0;
+
+    bool is_first_line = true;
+
+    size_t lcp = SIZE_MAX;
+
+    for (size_t i = 0; (i < n_keys) && !error_flag; ++i) {
+        if ((i > 0) && (lcps[i] < lcp)) {
+            lcp = lcps[i];
+        }
+
+        if (get_poem_line(&keys[i].line) == NULL) {
+            continue;
+        }
+
+        char lcp_str[32] = "";
+
+        int lcp_str_len = snprintf(lcp_str, sizeof(lcp_str), "%zu ", is_first_line ? 0 : lcp);
+
+        if ((lcp_str_len < 0) || write_to_output(&output, lcp_str, (size_t) lcp_str_len)) {
+            ERROR_OCCURRED_CALLING(write_to_output, "returned a non-zero value");
+
+            error_flag = -1;
+        } else if (write_line_to_file(&output, &keys[i].line)) {
+            ERROR_OCCURRED_CALLING(write_line_to_file, "returned a non-zero value");
+
+            error_flag = -1;
+        }
+
+        is_first_line = false;
+
+        lcp = SIZE_MAX;
+    }
+
+    if (close_output(&output)) {
+        ERROR_OCCURRED_CALLING(close_output, "returned a non-zero value");
+
+        error_flag = -1;
+    }
+
+    return error_flag;
 }
 
 /*!
@@ -505,18 +1860,18 @@ int tree_sort_and_output_to_file(const line_t *lines, size_t n_lines, comparator
         return -1;
     }
 
-    FILE *output = fopen(OUTPUT_FILE_NAME, "w");
+    output_t output = {};
 
-    if (output == NULL) {
-        ERROR_OCCURRED_CALLING(fopen, "returned NULL");
+    if (open_output(&output, OUTPUT_FILE_NAME, "w")) {
+        ERROR_OCCURRED_CALLING(open_output, "returned a non-zero value");
 
         delete_bst(root);
 
         return -1;
     }
 
-    int write_bst_to_file_error_flag = write_bst_to_file(output, root),
-        fclose_error_flag            = fclose(output);
+    int write_bst_to_file_error_flag = write_bst_to_file(&output, root),
+        close_output_error_flag      = close_output(&output);
 
     if (write_bst_to_file_error_flag) {
         ERROR_OCCURRED_CALLING(write_bst_to_file, "returned a non-zero value");
@@ -524,11 +1879,11 @@ int tree_sort_and_output_to_file(const line_t *lines, size_t n_lines, comparator
 
     delete_bst(root);
 
-    if (fclose_error_flag) {
-        ERROR_OCCURRED_CALLING(fclose, "returned a non-zero value");
+    if (close_output_error_flag) {
+        ERROR_OCCURRED_CALLING(close_output, "returned a non-zero value");
     }
 
-    return write_bst_to_file_error_flag && fclose_error_flag;
+    return write_bst_to_file_error_flag || close_output_error_flag;
 }
 
 /*!
@@ -628,14 +1983,14 @@ const node_t *insert_node_into_bst(node_t *parent, line_t line, comparator_func_
 /*!
  * Recursively writes BST to output file
  *
- * @param [in, out] output pointer to output file
+ * @param [in, out] output pointer to output
  * @param [in] current pointer to current node
  *
  * @return 0 in case of success, a non-zero value otherwise
  *
  * @note The output file name is OUTPUT_FILE_NAME
  */
-int write_bst_to_file(FILE *output, const node_t *current)
+int write_bst_to_file(output_t *output, const node_t *current)
 {
     assert(output != NULL);
     assert(current != NULL);
@@ -648,18 +2003,10 @@ int write_bst_to_file(FILE *output, const node_t *current)
         }
     }
 
-    const char *str = current->line.str;
-
-    while (isspace(*str)) {
-        ++str;
-    }
-
-    if (str[0] && islower(str[1])) {
-        if (fprintf(output, "%s\n", str) < 0) {
-            ERROR_OCCURRED_CALLING(fprintf, "returned a negative value");
+    if (write_line_to_file(output, &current->line)) {
+        ERROR_OCCURRED_CALLING(write_line_to_file, "returned a non-zero value");
 
-            return -1;
-        }
+        return -1;
     }
 
     if (current->right != NULL) {
@@ -693,6 +2040,220 @@ void delete_bst(node_t *current)
     FREE(current);
 }
 
+/*!
+ * Groups lines sharing the same rhyme key and writes the groups to output file, separated by empty lines.
+ * Lines inside each group keep their original order
+ *
+ * @param [in] lines pointer to array of pointers to line
+ * @param [in] n_lines the array size
+ * @param [in] line_cmp pointer to line comparator function, which is unused, so it may be NULL
+ *
+ * @return 0 in case of success, a non-zero value otherwise
+ *
+ * @note The output file name is OUTPUT_FILE_NAME
+ */
+int group_and_output_to_file(const line_t *lines, size_t n_lines, comparator_func_t *line_cmp)
+{
+    (void) line_cmp;
+
+    return group_lines_and_output_to_file(lines, n_lines, NULL);
+}
+
+/*!
+ * Groups lines sharing the same rhyme key, sorts lines inside each group and writes the groups to output file,
+ * separated by empty lines
+ *
+ * @param [in] lines pointer to array of pointers to line
+ * @param [in] n_lines the array size
+ * @param [in] line_cmp pointer to line comparator function
+ *
+ * @return 0 in case of success, a non-zero value otherwise
+ *
+ * @note The output file name is OUTPUT_FILE_NAME
+ */
+int group_sort_and_output_to_file(const line_t *lines, size_t n_lines, comparator_func_t *line_cmp)
+{
+    assert(line_cmp != NULL);
+
+    return group_lines_and_output_to_file(lines, n_lines, line_cmp);
+}
+
+/*!
+ * Groups lines by their rhyme keys in linear time using an open addressing hash table and writes the groups to
+ * output file in the order of their first appearance. Lines are then placed group by group into a single array
+ * using the group sizes, which are counted on the first pass
+ *
+ * @param [in] lines pointer to array of pointers to line
+ * @param [in] n_lines the array size
+ * @param [in] line_cmp pointer to the line comparator function used for sorting inside groups or NULL, if lines
+ * inside groups must keep their original order
+ *
+ * @return 0 in case of success, a non-zero value otherwise
+ *
+ * @note The output file name is OUTPUT_FILE_NAME
+ */
+int group_lines_and_output_to_file(const line_t *lines, size_t n_lines, comparator_func_t *line_cmp)
+{
+    assert(lines != NULL);
+
+    assert(n_lines > 0);
+
+    size_t capacity = 16;
+
+    while (capacity < 2 * n_lines) {
+        capacity *= 2;
+    }
+
+    /* The hash table, the line indices and the grouped lines are carved out of a single arena */
+    size_t groups_size = capacity * sizeof(rhyme_group_t),
+           indices_size = 2 * n_lines * sizeof(size_t),
+           grouped_lines_size = n_lines * sizeof(line_t);
+
+    char *arena = (char *) calloc(groups_size + indices_size + grouped_lines_size, 1);
+
+    if (arena == NULL) {
+        ERROR_OCCURRED_CALLING(calloc, "returned NULL");
+
+        return -1;
+    }
+
+    rhyme_group_t *groups = (rhyme_group_t *) arena;
+    size_t *indices       = (size_t *) (arena + groups_size);
+    line_t *grouped_lines = (line_t *) (arena + groups_size + indices_size);
+
+    size_t *line_groups = indices,
+           *group_order = indices + n_lines;
+
+    size_t n_groups = 0;
+
+    for (size_t i = 0; i < n_lines; ++i) {
+        char key[MAX_RHYME_KEY_LEN] = {};
+        size_t key_len = get_rhyme_key(&lines[i], key);
+
+        size_t slot = hash_rhyme_key(key, key_len) & (capacity - 1);
+
+        while (groups[slot].used &&
+               ((groups[slot].key_len != key_len) || (memcmp(groups[slot].key, key, key_len) != 0))) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+
+        if (!groups[slot].used) {
+            memcpy(groups[slot].key, key, key_len);
+            groups[slot].key_len = key_len;
+            groups[slot].used    = true;
+
+            group_order[n_groups++] = slot;
+        }
+
+        ++groups[slot].n_lines;
+        line_groups[i] = slot;
+    }
+
+    size_t offset = 0;
+
+    for (size_t i = 0; i < n_groups; ++i) {
+        groups[group_order[i]].offset = offset;
+        offset += groups[group_order[i]].n_lines;
+    }
+
+    for (size_t i = 0; i < n_lines; ++i) {
+        grouped_lines[groups[line_groups[i]].offset++] = lines[i];
+    }
+
+    int error_flag = 0;
+
+    output_t output = {};
+
+    if (open_output(&output, OUTPUT_FILE_NAME, "w")) {
+        ERROR_OCCURRED_CALLING(open_output, "returned a non-zero value");
+
+        error_flag = -1;
+    }
+
+    for (size_t i = 0, group_begin = 0; (i < n_groups) && !error_flag; ++i) {
+        size_t group_n_lines = groups[group_order[i]].n_lines;
+
+        if (line_cmp != NULL) {
+            qsort(grouped_lines + group_begin, group_n_lines, sizeof(*grouped_lines), line_cmp);
+        }
+
+        size_t group_position = output.position;
+
+        for (size_t j = group_begin; (j < group_begin + group_n_lines) && !error_flag; ++j) {
+            if (write_line_to_file(&output, &grouped_lines[j])) {
+                ERROR_OCCURRED_CALLING(write_line_to_file, "returned a non-zero value");
+
+                error_flag = -1;
+            }
+        }
+
+        if (!error_flag && (output.position != group_position) && write_to_output(&output, "\n", 1)) {
+            ERROR_OCCURRED_CALLING(write_to_output, "returned a non-zero value");
+
+            error_flag = -1;
+        }
+
+        group_begin += group_n_lines;
+    }
+
+    if (close_output(&output)) {
+        ERROR_OCCURRED_CALLING(close_output, "returned a non-zero value");
+
+        error_flag = -1;
+    }
+
+    FREE(arena);
+
+    return error_flag;
+}
+
+/*!
+ * Gets the rhyme key of a line, which consists of its last RHYME_KEY_LEN letters converted to lowercase,
+ * starting from the last one
+ *
+ * @param [in] line pointer to line
+ * @param [out] key pointer to array of at least RHYME_KEY_LEN chars
+ *
+ * @return the key length, which is less than RHYME_KEY_LEN if the line has fewer letters
+ */
+size_t get_rhyme_key(const line_t *line, char *key)
+{
+    assert(line != NULL);
+    assert(key != NULL);
+
+    size_t key_len = 0;
+
+    for (size_t i = line->len; (i > 0) && (key_len < RHYME_KEY_LEN); --i) {
+        if (is_alpha(line->str[i - 1])) {
+            key[key_len++] = (char) to_lower(line->str[i - 1]);
+        }
+    }
+
+    return key_len;
+}
+
+/*!
+ * Hashes a rhyme key using the 32-bit FNV-1a hash function
+ *
+ * @param [in] key pointer to key
+ * @param [in] key_len the key length
+ *
+ * @return the hash value
+ */
+size_t hash_rhyme_key(const char *key, size_t key_len)
+{
+    assert(key != NULL);
+
+    uint32_t hash = 2166136261u;
+
+    for (size_t i = 0; i < key_len; ++i) {
+        hash ^= (unsigned char) key[i];
+        hash *= 16777619u;
+    }
+
+    return (size_t) hash;
+}
+
 /*!
  * Wrapper over standard library isalpha function. Preliminarily converts parameter to unsigned char type
  *
@@ -1,13 +1,56 @@
 #ifdef _WIN32
 #define _CRT_SECURE_NO_WARNINGS
+#define _USE_MATH_DEFINES
 #endif
 
 #include <assert.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <float.h>
 #include <math.h>
 
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SOLVE_SQUARE_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+/*
+ * Contracting multiplications and additions into FMA would make the results of solve_square depend on the
+ * instruction set it's compiled for, so that they would differ from the results of the vectorized kernels
+ */
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
 /*!
  * Constant for indicating infinite number of roots
  */
@@ -16,15 +59,445 @@ const int INF_ROOTS = -1;
 /*!
  * Constant for floating point number tolerance
  */
-const double EPS = 1e-10;
+constexpr double EPS = 1e-10;
+
+/*!
+ * Constant for single precision floating point number tolerance, in single precision machine epsilons, so that it
+ * follows the precision instead of being tuned by hand
+ */
+constexpr float EPS_F = 128 * FLT_EPSILON;
+
+/*!
+ * Constant defining how many single precision machine epsilons of the discriminant's magnitude make it
+ * ill-conditioned in the mixed precision solver
+ */
+const float MIXED_REFINE_FACTOR = 64;
+
+/*!
+ * Constant defining the maximum ratio of b^2 to |4ac|, above which the lesser root loses too much precision to
+ * cancellation in the mixed precision solver
+ */
+const float MIXED_MAX_CANCELLATION = 256;
+
+/*!
+ * Constant defining the number of equations converted to single precision by the mixed precision solver at a time
+ */
+const size_t MIXED_BLOCK_SIZE = 1024;
+
+/*!
+ * Constant defining the command line usage hint
+ */
+const char *USAGE = "use --t or -test for testing program, --f or -file followed by the input file and optionally the "
+                    "output file for solving equations from file, --m or -mapped followed by the input and output "
+                    "binary files for solving equations from binary file, --u or -ulp optionally followed by the "
+                    "number of equations for measuring the accuracy of the solvers, --p or -perf optionally "
+                    "followed by the number of equations and the distribution of coefficients (random, degenerate, "
+                    "near_zero_discriminant or mixed_sign) for benchmarking the solvers, --s or -server optionally "
+                    "followed by the Unix socket path or - for stdin, the maximum batch size and the latency budget "
+                    "in microseconds for serving requests";
+
+/*!
+ * Constant defining the number of Newton's method iterations polishing the resolvent cubic root in solve_quartic
+ */
+const int RESOLVENT_NEWTON_ITERATIONS = 2;
+
+/*!
+ * Constant defining the default number of random equations solved for measuring the accuracy of the solvers
+ */
+const size_t DEFAULT_ULP_TEST_SIZE = 1 << 20;
+
+/*!
+ * Constant defining the default number of random equations solved by each solver in the benchmark
+ */
+const size_t DEFAULT_BENCHMARK_SIZE = 1 << 20;
+
+/*!
+ * Constant defining how many times each solver is run in the benchmark, the best time is reported
+ */
+const int BENCHMARK_REPETITIONS = 5;
+
+/*!
+ * Constant defining the default maximum number of requests solved by the server at a time
+ */
+const size_t DEFAULT_SERVER_BATCH_SIZE = 64;
+
+/*!
+ * Constant defining the default time in microseconds, for which the server waits for more requests to batch with
+ * the first pending one
+ */
+const long DEFAULT_SERVER_LATENCY_BUDGET_US = 50;
+
+/*!
+ * Constant defining the size of the buffer, by which the server reads requests
+ */
+const size_t SERVER_READ_SIZE = 4096;
+
+/*!
+ * Constant defining the maximum length of a request line
+ */
+const size_t MAX_REQUEST_LEN = 256;
+
+/*!
+ * Constant defining the size of the unsent answers of a client, beyond which the server stops reading its requests
+ */
+const size_t MAX_SERVER_OUTPUT_SIZE = 1 << 16;
+
+/*!
+ * Constant defining the time in microseconds, for which the quitting server waits for the clients to read their answers
+ */
+const long SERVER_SHUTDOWN_TIMEOUT_US = 1000000;
+
+/*!
+ * Constant defining the response to an invalid request
+ */
+const char INVALID_REQUEST_RESPONSE[] = "ERROR: invalid request\n";
+
+/*!
+ * Constant defining the minimum size of an input file chunk parsed by a separate thread
+ */
+const size_t MIN_PARSE_CHUNK_SIZE = 1 << 20;
+
+/*!
+ * Constant defining the number of equations solved and written to the output file at a time
+ */
+const size_t SOLVE_BATCH_SIZE = 4096;
+
+/*!
+ * Constant defining the number of equations in a block solved by a thread at a time, so that the block's
+ * coefficients and solutions fit in cache
+ */
+const size_t PARALLEL_BLOCK_SIZE = 4096;
+
+/*!
+ * Constant defining the maximum length of a formatted solution line
+ */
+const size_t MAX_SOLUTION_LEN = 64;
+
+/*!
+ * Constant defining the characters separating coefficients in an input line
+ */
+const char COEFFICIENT_SEPARATORS[] = " \t\r,;";
+
+/*!
+ * Constant defining the magic of binary coefficient files
+ */
+const char BINARY_INPUT_MAGIC[8] = "SQEQCFS";
+
+/*!
+ * Constant defining the magic of binary solution files
+ */
+const char BINARY_OUTPUT_MAGIC[8] = "SQEQSLN";
+
+/*!
+ * Constant defining the current version of binary files
+ */
+const uint32_t BINARY_VERSION = 1;
+
+/*!
+ * Constant defining the alignment of columns in binary files
+ */
+const size_t BINARY_COLUMN_ALIGNMENT = 64;
+
+/*!
+ * Data structure defining the header of binary coefficient and solution files.
+ *
+ * A binary coefficient file consists of the header followed by the columns of a, b and c coefficients. A binary
+ * solution file consists of the header followed by the columns of numbers of roots (int32_t), greater roots and
+ * lesser roots. Roots and coefficients are doubles, all values are in the host byte order. Each column starts at
+ * header_size bytes from the file beginning plus the sizes of the previous columns, each padded up to
+ * BINARY_COLUMN_ALIGNMENT bytes
+ */
+struct binary_header_t {
+    char magic[8];
+
+    uint32_t version;
+    uint32_t header_size;
+
+    uint64_t n_equations;
+
+    char reserved[40];
+};
+
+static_assert(sizeof(binary_header_t) % BINARY_COLUMN_ALIGNMENT == 0, "binary header breaks column alignment");
+static_assert(sizeof(int) == sizeof(int32_t), "numbers of roots are stored as int32_t");
+
+/*!
+ * Data structure defining the numbers of equations for each number of roots
+ */
+struct root_count_stats_t {
+    size_t n_no_roots;
+    size_t n_one_root;
+    size_t n_two_roots;
+    size_t n_inf_roots;
+};
+
+/*!
+ * Data structure defining root count statistics of a thread, aligned to avoid false sharing
+ */
+struct alignas(64) thread_root_count_stats_t {
+    root_count_stats_t stats;
+};
+
+/*!
+ * Data structure defining a file mapped to memory
+ */
+struct mapped_file_t {
+    void *data;
+    size_t size;
+
+    int writable;
+
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#else
+    int fd;
+#endif
+};
+
+/*!
+ * Data structure defining a chunk of the input file, which is parsed by a separate thread
+ */
+struct parse_chunk_t {
+    const char *begin;
+    const char *end;
+
+    size_t offset;
+    size_t n_equations;
+
+    const char *error_line;
+};
+
+/*!
+ * Data structure defining a double-double number: the unevaluated sum of hi and lo, |lo| <= ulp(hi) / 2, which has
+ * about 106 significant bits, whatever long double is
+ */
+struct double_double_t {
+    double hi;
+    double lo;
+};
+
+/*!
+ * Data structure defining the hardware counters of branches and branch misses of the process and its threads
+ */
+struct branch_counters_t {
+    int branches_fd;
+    int misses_fd;
+};
+
+/*!
+ * Data structure defining a client of the server with its pending request bytes and unsent responses
+ */
+struct server_client_t {
+    int in_fd;
+    int out_fd;
+
+    std::vector<char> input;
+    std::vector<char> output;
+
+    int is_closed;
+    int is_output_broken;
+    int is_skipping_line;
+};
+
+/*!
+ * Data structure defining a micro-batch of requests of the server in the order of their arrival
+ */
+struct server_batch_t {
+    std::vector<double> a, b, c, root1, root2;
+    std::vector<int> n_roots;
+
+    std::vector<size_t> client_i;
+    std::vector<char> is_valid;
+
+    size_t n_requests;
+
+    std::chrono::steady_clock::time_point start;
+};
+
+/*!
+ * Data structure defining the roots of a square equation, as an entry of a compile-time root table
+ */
+template <typename T>
+struct square_roots_t {
+    int n_roots = 0;
+    T root1 = 0;
+    T root2 = 0;
+};
+
+/*!
+ * Data structure defining a compile-time table of the roots of square equations over a grid of coefficients
+ *
+ * @note The roots of the equation with coefficients a[i_a], b[i_b], c[i_c] are at
+ * entries[(i_a * N_B + i_b) * N_C + i_c]
+ */
+template <typename T, size_t N_A, size_t N_B, size_t N_C>
+struct square_root_table_t {
+    square_roots_t<T> entries[N_A * N_B * N_C] = {};
+
+    constexpr const square_roots_t<T> &get(size_t i_a, size_t i_b, size_t i_c) const
+    {
+        return entries[(i_a * N_B + i_b) * N_C + i_c];
+    }
+};
 
 int solve_square(double a, double b, double c, double *root1, double *root2);
 int solve_linear(double b, double c, double *root);
 
 int are_almost_equal(double f1, double f2);
 
+int classify_square(double a, double b, double c);
+
+int solve_square_stable(double a, double b, double c, double *root1, double *root2);
+double get_discriminant_compensated(double a, double b, double c);
+
+int solve_cubic(double a, double b, double c, double d, double *roots);
+int solve_quartic(double a, double b, double c, double d, double e, double *roots);
+int sort_unique_roots(double *roots, int n_roots);
+
+template <typename T> constexpr int solve_square_constexpr(T a, T b, T c, T *root1, T *root2);
+template <typename T> constexpr int solve_linear_constexpr(T b, T c, T *root);
+template <typename T> constexpr int are_almost_equal_constexpr(T flt1, T flt2);
+template <typename T> constexpr T get_tolerance(void);
+template <typename T> constexpr int is_finite_constexpr(T flt);
+template <typename T> constexpr T sqrt_constexpr(T flt);
+template <typename T, size_t N_A, size_t N_B, size_t N_C>
+constexpr square_root_table_t<T, N_A, N_B, N_C> make_square_root_table(const T (&a)[N_A], const T (&b)[N_B],
+                                                                      const T (&c)[N_C]);
+
+int solve_square_f(float a, float b, float c, float *root1, float *root2);
+int solve_linear_f(float b, float c, float *root);
+
+int are_almost_equal_f(float flt1, float flt2);
+
+typedef void solve_square_batch_kernel_t(const double *a, const double *b, const double *c, size_t n,
+                                         int *n_roots, double *root1, double *root2);
+
+void solve_square_batch(const double *a, const double *b, const double *c, size_t n,
+                        int *n_roots, double *root1, double *root2);
+solve_square_batch_kernel_t *select_solve_square_batch_kernel(void);
+void solve_square_batch_scalar(const double *a, const double *b, const double *c, size_t n,
+                               int *n_roots, double *root1, double *root2);
+void solve_square_batch_parallel(const double *a, const double *b, const double *c, size_t n,
+                                 int *n_roots, double *root1, double *root2,
+                                 size_t n_threads, root_count_stats_t *stats);
+void count_roots(const int *n_roots, size_t n, root_count_stats_t *stats);
+
+typedef void classify_square_batch_kernel_t(const double *a, const double *b, const double *c, size_t n,
+                                           int *n_roots);
+
+void classify_square_batch(const double *a, const double *b, const double *c, size_t n,
+                           int *n_roots, root_count_stats_t *stats);
+classify_square_batch_kernel_t *select_classify_square_batch_kernel(void);
+void classify_square_batch_scalar(const double *a, const double *b, const double *c, size_t n, int *n_roots);
+
+void solve_cubic_batch(const double *a, const double *b, const double *c, const double *d, size_t n,
+                       int *n_roots, double *root1, double *root2, double *root3);
+void solve_quartic_batch(const double *a, const double *b, const double *c, const double *d, const double *e, size_t n,
+                         int *n_roots, double *root1, double *root2, double *root3, double *root4);
+
+typedef void solve_square_batch_f_kernel_t(const float *a, const float *b, const float *c, size_t n,
+                                           int *n_roots, float *root1, float *root2);
+
+void solve_square_batch_f(const float *a, const float *b, const float *c, size_t n,
+                          int *n_roots, float *root1, float *root2);
+solve_square_batch_f_kernel_t *select_solve_square_batch_f_kernel(void);
+void solve_square_batch_f_scalar(const float *a, const float *b, const float *c, size_t n,
+                                 int *n_roots, float *root1, float *root2);
+void solve_square_batch_mixed(const double *a, const double *b, const double *c, size_t n,
+                              int *n_roots, double *root1, double *root2);
+int is_ill_conditioned_f(float a, float b, float c);
+#ifdef SOLVE_SQUARE_X86_KERNELS
+void solve_square_batch_sse2(const double *a, const double *b, const double *c, size_t n,
+                             int *n_roots, double *root1, double *root2);
+void solve_square_batch_avx2(const double *a, const double *b, const double *c, size_t n,
+                             int *n_roots, double *root1, double *root2);
+void solve_square_batch_avx512(const double *a, const double *b, const double *c, size_t n,
+                               int *n_roots, double *root1, double *root2);
+void classify_square_batch_sse2(const double *a, const double *b, const double *c, size_t n, int *n_roots);
+void classify_square_batch_avx2(const double *a, const double *b, const double *c, size_t n, int *n_roots);
+void classify_square_batch_avx512(const double *a, const double *b, const double *c, size_t n, int *n_roots);
+void solve_square_batch_f_sse2(const float *a, const float *b, const float *c, size_t n,
+                               int *n_roots, float *root1, float *root2);
+void solve_square_batch_f_avx2(const float *a, const float *b, const float *c, size_t n,
+                               int *n_roots, float *root1, float *root2);
+void solve_square_batch_f_avx512(const float *a, const float *b, const float *c, size_t n,
+                                 int *n_roots, float *root1, float *root2);
+#endif
+
+int solve_square_file(const char *input_file_name, const char *output_file_name);
+char *read_file(const char *file_name, size_t *size);
+size_t count_lines(const char *begin, const char *end);
+void parse_coefficients(parse_chunk_t *chunk, double *a, double *b, double *c);
+char *format_solution(char *writer, int n_roots, double root1, double root2);
+
+int solve_square_mapped(const char *input_file_name, const char *output_file_name);
+size_t get_binary_column_size(size_t n_elements, size_t element_size);
+size_t find_non_finite_coefficients(const double *a, const double *b, const double *c, size_t n);
+int map_file(const char *file_name, size_t size, int writable, mapped_file_t *mapped);
+int unmap_file(mapped_file_t *mapped);
+
+int measure_solve_square_ulp(size_t n_equations);
+int solve_square_reference(double a, double b, double c, double_double_t *root1, double_double_t *root2);
+double get_ulp_error(double root, double_double_t reference_root);
+double_double_t add_double_double(double_double_t x, double_double_t y);
+double_double_t multiply_double_double(double_double_t x, double_double_t y);
+double_double_t divide_double_double(double_double_t x, double_double_t y);
+double_double_t sqrt_double_double(double_double_t x);
+double_double_t make_double_double(double hi, double lo);
+double get_random_coefficient(double min_exponent, double max_exponent);
+int parse_count(const char *str, size_t *count);
+
+typedef void generate_coefficients_t(double *a, double *b, double *c, size_t n);
+
+int benchmark_solve_square(size_t n_equations, const char *distribution_name);
+void generate_random_coefficients(double *a, double *b, double *c, size_t n);
+void generate_degenerate_coefficients(double *a, double *b, double *c, size_t n);
+void generate_near_zero_discriminant_coefficients(double *a, double *b, double *c, size_t n);
+void generate_mixed_sign_coefficients(double *a, double *b, double *c, size_t n);
+void benchmark_solve_square_stable(const double *a, const double *b, const double *c, size_t n,
+                                   int *n_roots, double *root1, double *root2);
+void benchmark_solve_square_batch_parallel(const double *a, const double *b, const double *c, size_t n,
+                                           int *n_roots, double *root1, double *root2);
+void benchmark_classify_square_batch(const double *a, const double *b, const double *c, size_t n,
+                                     int *n_roots, double *root1, double *root2);
+int open_branch_counters(branch_counters_t *counters);
+int open_perf_event(uint64_t config);
+void enable_branch_counters(const branch_counters_t *counters, int enable);
+int read_branch_counters(const branch_counters_t *counters, uint64_t *n_branches, uint64_t *n_misses);
+void close_branch_counters(branch_counters_t *counters);
+
+int run_solve_square_server(const char *socket_path, size_t batch_size, long latency_budget_us);
+#ifndef _WIN32
+int open_server_socket(const char *socket_path);
+int wait_for_requests(pollfd *fds, size_t n_fds, long timeout_us);
+int read_server_requests(std::vector<server_client_t> *clients, size_t client_i, server_batch_t *batch);
+void add_server_request(server_batch_t *batch, size_t client_i, const char *line, const char *line_end);
+void init_server_batch(server_batch_t *batch, size_t batch_size);
+long get_server_batch_age_us(const server_batch_t *batch);
+void flush_server_batch(std::vector<server_client_t> *clients, server_batch_t *batch);
+int write_server_output(server_client_t *client);
+void drain_server_output(std::vector<server_client_t> *clients);
+#endif
+
 int test_case(const char *name, int expr);
+void generate_test_coefficients(double *a, double *b, double *c, size_t n, unsigned seed);
 void test_solve_square(void);
+void test_solve_square_batch(void);
+void test_solve_square_batch_parallel(void);
+void test_parse_coefficients(void);
+void test_solve_square_float(void);
+void test_solve_square_mapped(void);
+int write_test_coefficient_file(const char *file_name, const double *a, const double *b, const double *c, size_t n);
+void test_classify_square(void);
+void test_solve_cubic_quartic(void);
+void test_solve_square_constexpr(void);
+void test_solve_square_stable(void);
+void test_solve_square_server(void);
+#ifndef _WIN32
+int serve_test_requests(const char *const *inputs, size_t n_inputs, size_t batch_size,
+                        char *output, size_t output_size);
+#endif
 
 int main(int argc, const char *argv[])
 {
@@ -61,15 +534,69 @@ int main(int argc, const char *argv[])
         }
 
         return EXIT_SUCCESS;
+    } else if (((argc == 2) || (argc == 3)) && (strcmp(argv[1], "--u") == 0 || strcmp(argv[1], "-ulp") == 0)) {
+        size_t n_equations = DEFAULT_ULP_TEST_SIZE;
+
+        if ((argc == 3) && parse_count(argv[2], &n_equations)) {
+            printf("ERROR: invalid number of equations, %s\n", USAGE);
+            return EXIT_FAILURE;
+        }
+
+        return measure_solve_square_ulp(n_equations) ? EXIT_FAILURE : EXIT_SUCCESS;
+    } else if (((argc >= 2) && (argc <= 4)) && (strcmp(argv[1], "--p") == 0 || strcmp(argv[1], "-perf") == 0)) {
+        size_t n_equations = DEFAULT_BENCHMARK_SIZE;
+
+        if ((argc >= 3) && parse_count(argv[2], &n_equations)) {
+            printf("ERROR: invalid number of equations, %s\n", USAGE);
+            return EXIT_FAILURE;
+        }
+
+        return benchmark_solve_square(n_equations, (argc == 4) ? argv[3] : NULL) ? EXIT_FAILURE : EXIT_SUCCESS;
+    } else if (((argc >= 2) && (argc <= 5)) && (strcmp(argv[1], "--s") == 0 || strcmp(argv[1], "-server") == 0)) {
+        const char *socket_path = ((argc >= 3) && (strcmp(argv[2], "-") != 0)) ? argv[2] : NULL;
+
+        size_t batch_size = DEFAULT_SERVER_BATCH_SIZE;
+        long latency_budget_us = DEFAULT_SERVER_LATENCY_BUDGET_US;
+
+        if ((argc >= 4) && parse_count(argv[3], &batch_size)) {
+            printf("ERROR: invalid batch size, %s\n", USAGE);
+            return EXIT_FAILURE;
+        }
+
+        if (argc == 5) {
+            char *end = NULL;
+            latency_budget_us = strtol(argv[4], &end, 10);
+
+            if ((end == argv[4]) || (*end != '\0') || (latency_budget_us < 0)) {
+                printf("ERROR: invalid latency budget, %s\n", USAGE);
+                return EXIT_FAILURE;
+            }
+        }
+
+        return run_solve_square_server(socket_path, batch_size, latency_budget_us) ? EXIT_FAILURE : EXIT_SUCCESS;
     } else if (argc == 2) {
         if (strcmp(argv[1], "--t") == 0 || strcmp(argv[1], "-test") == 0) {
             test_solve_square();
+            test_solve_square_batch();
+            test_solve_square_batch_parallel();
+            test_parse_coefficients();
+            test_solve_square_float();
+            test_solve_square_mapped();
+            test_classify_square();
+            test_solve_cubic_quartic();
+            test_solve_square_constexpr();
+            test_solve_square_stable();
+            test_solve_square_server();
         } else {
-            printf("ERROR: invalid command line argument, use --t or -test for testing program\n");
+            printf("ERROR: invalid command line argument, %s\n", USAGE);
             return EXIT_FAILURE;
         }
+    } else if (((argc == 3) || (argc == 4)) && (strcmp(argv[1], "--f") == 0 || strcmp(argv[1], "-file") == 0)) {
+        return solve_square_file(argv[2], (argc == 4) ? argv[3] : NULL) ? EXIT_FAILURE : EXIT_SUCCESS;
+    } else if ((argc == 4) && (strcmp(argv[1], "--m") == 0 || strcmp(argv[1], "-mapped") == 0)) {
+        return solve_square_mapped(argv[2], argv[3]) ? EXIT_FAILURE : EXIT_SUCCESS;
     } else {
-        printf("ERROR: invalid command line arguments, use --t or -test for testing program\n");
+        printf("ERROR: invalid command line arguments, %s\n", USAGE);
         return EXIT_FAILURE;
     }
 }
@@ -80,8 +607,8 @@ int main(int argc, const char *argv[])
  * @param a [in] quadratic coefficient
  * @param b [in] linear coefficient
  * @param c [in] free term
- * @param root1 [out] pointer to the greater root
- * @param root2 [out] pointer to the lesser root
+ * @param root1 [out] pointer to the root (-b + sqrt(d)) / 2a, which is the greater one if a > 0
+ * @param root2 [out] pointer to the root (-b - sqrt(d)) / 2a
  *
  * @return the number of roots
  *
@@ -165,59 +692,4509 @@ int are_almost_equal(double dbl1, double dbl2)
 }
 
 /*!
- * Tests a case
+ * Classifies square equation ax^2 + bx + c = 0 by the number of its roots without computing them
  *
- * @param [in] name name of test case
- * @param [in] expr expression to be tested
+ * @param a [in] quadratic coefficient
+ * @param b [in] linear coefficient
+ * @param c [in] free term
  *
- * @return 1 if expr is true, otherwise 0
+ * @return the number of roots, the same as of solve_square
+ *
+ * @note Returns INF_ROOTS in case of an infinite number of roots
  */
-int test_case(const char *name, int expr)
+int classify_square(double a, double b, double c)
 {
-    if (expr) {
-        printf("\ttest \"%s\" passed\n", name);
+    assert(isfinite(a));
+    assert(isfinite(b));
+    assert(isfinite(c));
+
+    if (are_almost_equal(a, 0)) {
+        if (are_almost_equal(b, 0)) {
+            return (are_almost_equal(c, 0)) ? INF_ROOTS : 0;
+        }
+
+        return 1;
+    }
+
+    double d = b * b - 4 * a * c;
+
+    if (are_almost_equal(d, 0)) {
         return 1;
-    } else {
-        printf("\ttest \"%s\" failed\n", name);
-        return 0;
     }
+
+    return (d > 0) ? 2 : 0;
 }
 
 /*!
- * Tests solve_square function
+ * Solves square equation ax^2 + bx + c = 0 like solve_square, but without losing precision to cancellation
+ *
+ * @param a [in] quadratic coefficient
+ * @param b [in] linear coefficient
+ * @param c [in] free term
+ * @param root1 [out] pointer to the root (-b + sqrt(d)) / 2a, like of solve_square
+ * @param root2 [out] pointer to the root (-b - sqrt(d)) / 2a, like of solve_square
+ *
+ * @return the number of roots, the same as of solve_square
+ *
+ * @note Returns INF_ROOTS in case of an infinite number of roots
+ * @note The discriminant is computed by get_discriminant_compensated. The root of the greater magnitude is computed
+ * as q/a, where q = -(b + sign(b)sqrt(d))/2 adds numbers of the same sign, and the other one as c/q (citardauq
+ * formula), so that neither subtracts almost equal numbers
  */
-void test_solve_square(void)
+int solve_square_stable(double a, double b, double c, double *root1, double *root2)
 {
-    printf("Testing solve_square function:\n");
+    assert(isfinite(a));
+    assert(isfinite(b));
+    assert(isfinite(c));
 
-    double root1 = 0, root2 = 0;
+    assert(root1 != NULL);
+    assert(root2 != NULL);
+    assert(root1 != root2);
 
-    int n_tests_passed = 0, n_tests_failed = 0;
+    if (are_almost_equal(a, 0)) {
+        int n_roots = solve_linear(b, c, root1);
+        *root2 = *root1;
 
-#define TEST_CASE(name, expr) (test_case((name), (expr)) ? ++n_tests_passed : ++n_tests_failed)
+        return n_roots;
+    }
 
-    TEST_CASE("infinite number of roots",
-              solve_square(0, 0, 0, &root1, &root2) == INF_ROOTS);
-    TEST_CASE("0 roots, constant equation",
-              solve_square(0, 0, 1, &root1, &root2) == 0);
-    TEST_CASE("0 roots, quadratic equation",
-              solve_square(1, 1, 1, &root1, &root2) == 0);
-    TEST_CASE("1 root, linear equation, number of roots",
-              solve_square(0, 1, 1, &root1, &root2) == 1);
-    TEST_CASE("1 root, linear equation, correctness of roots",
-              are_almost_equal(root1, root2) && are_almost_equal(root1, -1));
-    TEST_CASE("1 root, quadratic equation, number of roots",
-              solve_square(1, -2, 1, &root1, &root2) == 1);
-    TEST_CASE("1 root, quadratic equation, correctness of roots",
-              are_almost_equal(root1, root2) && are_almost_equal(root1, 1));
-    TEST_CASE("2 roots, number of roots",
-              solve_square(2, 5, 3, &root1, &root2) == 2);
-    TEST_CASE("2 roots, correctness of roots",
-              are_almost_equal(root1, -1) && are_almost_equal(root2, -1.5));
+    double d = get_discriminant_compensated(a, b, c);
 
-#undef TEST_CASE
+    if (are_almost_equal(d, 0)) {
+        *root1 = *root2 = -b / (2 * a);
 
-    printf("Finished testing solve_square function: %d tests passed, %d tests failed. The"
-           "total number of tests was: %d\n",
-           n_tests_passed, n_tests_failed, n_tests_passed + n_tests_failed);
-}
\ No newline at end of file
+        return 1;
+    }
+
+    if (d < 0) {
+        return 0;
+    }
+
+    double q = -0.5 * (b + copysign(sqrt(d), b));
+
+    /* q can't be 0, because d > 0. q/a takes the sign of sqrt(d) opposite to the sign of b */
+    double x1 = q / a, x2 = c / q;
+
+    *root1 = signbit(b) ? x1 : x2;
+    *root2 = signbit(b) ? x2 : x1;
+
+    return 2;
+}
+
+/*!
+ * Computes the discriminant b^2 - 4ac of square equation with compensation of the rounding errors of the products
+ *
+ * @param a [in] quadratic coefficient
+ * @param b [in] linear coefficient
+ * @param c [in] free term
+ *
+ * @return the discriminant
+ *
+ * @note The rounding errors of b^2 and 4ac are computed exactly by FMA (Kahan's algorithm), so the discriminant is
+ * accurate even when b^2 and 4ac almost cancel out. Without hardware FMA, fma is emulated and much slower
+ */
+double get_discriminant_compensated(double a, double b, double c)
+{
+    double b_squared = b * b;
+    double four_ac   = 4 * a * c;
+
+    double b_squared_error = fma(b, b, -b_squared);
+    double four_ac_error   = fma(4 * a, c, -four_ac);
+
+    return (b_squared - four_ac) + (b_squared_error - four_ac_error);
+}
+
+/*!
+ * Solves cubic equation ax^3 + bx^2 + cx + d = 0 by Cardano's formula and saves its roots
+ *
+ * @param a [in] cubic coefficient
+ * @param b [in] quadratic coefficient
+ * @param c [in] linear coefficient
+ * @param d [in] free term
+ * @param roots [out] array of at least 3 elements for the distinct roots in descending order
+ *
+ * @return the number of roots
+ *
+ * @note Returns INF_ROOTS in case of an infinite number of roots
+ * @note In case of 3 real roots the trigonometric form is used, so that no complex arithmetic is needed
+ */
+int solve_cubic(double a, double b, double c, double d, double *roots)
+{
+    assert(isfinite(a));
+    assert(isfinite(b));
+    assert(isfinite(c));
+    assert(isfinite(d));
+
+    assert(roots != NULL);
+
+    if (are_almost_equal(a, 0)) {
+        int n_roots = solve_square(b, c, d, &roots[0], &roots[1]);
+
+        return (n_roots == INF_ROOTS) ? INF_ROOTS : sort_unique_roots(roots, n_roots);
+    }
+
+    b /= a;
+    c /= a;
+    d /= a;
+
+    /* Substitution x = t - b/3 gives depressed cubic t^3 + pt + q = 0 */
+    double shift = -b / 3;
+    double p = c - b * b / 3;
+    double q = 2 * b * b * b / 27 - b * c / 3 + d;
+
+    double half_q = q / 2, third_p = p / 3;
+    double discriminant = half_q * half_q + third_p * third_p * third_p;
+
+    int n_roots = 0;
+
+    if (are_almost_equal(discriminant, 0)) {
+        if (are_almost_equal(p, 0)) {
+            roots[0] = shift;
+            n_roots = 1;
+        } else {
+            roots[0] = 3 * q / p + shift;
+            roots[1] = -3 * q / (2 * p) + shift;
+            n_roots = 2;
+        }
+    } else if (discriminant > 0) {
+        double sqrt_discriminant = sqrt(discriminant);
+
+        roots[0] = cbrt(-half_q + sqrt_discriminant) + cbrt(-half_q - sqrt_discriminant) + shift;
+        n_roots = 1;
+    } else {
+        /* discriminant < 0 implies p < 0 */
+        double amplitude = 2 * sqrt(-third_p);
+        double cos_3phi = 3 * q / (p * amplitude);
+        double phi = acos(fmax(-1.0, fmin(1.0, cos_3phi))) / 3;
+
+        for (int k = 0; k < 3; ++k) {
+            roots[k] = amplitude * cos(phi - 2 * M_PI * k / 3) + shift;
+        }
+
+        n_roots = 3;
+    }
+
+    return sort_unique_roots(roots, n_roots);
+}
+
+/*!
+ * Solves quartic equation ax^4 + bx^3 + cx^2 + dx + e = 0 by Ferrari's method and saves its roots
+ *
+ * @param a [in] quartic coefficient
+ * @param b [in] cubic coefficient
+ * @param c [in] quadratic coefficient
+ * @param d [in] linear coefficient
+ * @param e [in] free term
+ * @param roots [out] array of at least 4 elements for the distinct roots in descending order
+ *
+ * @return the number of roots
+ *
+ * @note Returns INF_ROOTS in case of an infinite number of roots
+ * @note The depressed quartic is factored into 2 square equations using the greatest root of the resolvent cubic
+ */
+int solve_quartic(double a, double b, double c, double d, double e, double *roots)
+{
+    assert(isfinite(a));
+    assert(isfinite(b));
+    assert(isfinite(c));
+    assert(isfinite(d));
+    assert(isfinite(e));
+
+    assert(roots != NULL);
+
+    if (are_almost_equal(a, 0)) {
+        return solve_cubic(b, c, d, e, roots);
+    }
+
+    b /= a;
+    c /= a;
+    d /= a;
+    e /= a;
+
+    /* Substitution x = y - b/4 gives depressed quartic y^4 + py^2 + qy + r = 0 */
+    double shift = -b / 4;
+    double p = c - 3 * b * b / 8;
+    double q = d - b * c / 2 + b * b * b / 8;
+    double r = e - b * d / 4 + b * b * c / 16 - 3 * b * b * b * b / 256;
+
+    /*
+     * (y^2 + p/2 + m)^2 = (sy - q/(2s))^2, s = sqrt(2m), holds when m is a root of the resolvent cubic
+     * 8m^3 + 8pm^2 + (2p^2 - 8r)m - q^2 = 0, whose greatest root is positive, because q != 0
+     */
+    double m = 0, s = 0;
+
+    if (!are_almost_equal(q, 0)) {
+        double resolvent_roots[3] = {};
+        int n_resolvent_roots = solve_cubic(8, 8 * p, 2 * p * p - 8 * r, -q * q, resolvent_roots);
+        assert(n_resolvent_roots > 0);
+
+        m = resolvent_roots[0];
+
+        /* The root is polished, since q/(2s) amplifies its error, when it's close to 0 */
+        for (int i = 0; i < RESOLVENT_NEWTON_ITERATIONS; ++i) {
+            double resolvent            = ((8 * m + 8 * p) * m + 2 * p * p - 8 * r) * m - q * q,
+                   resolvent_derivative = (24 * m + 16 * p) * m + 2 * p * p - 8 * r;
+
+            if (!are_almost_equal(resolvent_derivative, 0)) {
+                m -= resolvent / resolvent_derivative;
+            }
+        }
+
+        m = fmax(m, 0);
+        s = sqrt(2 * m);
+    }
+
+    int n_roots = 0;
+
+    if (are_almost_equal(s, 0)) {
+        /* q is negligible, so that the equation is biquadratic and is solved as square equation in y^2 */
+        double z[2] = {};
+        int n_z = solve_square(1, p, r, &z[0], &z[1]);
+
+        for (int i = 0; i < n_z; ++i) {
+            if (are_almost_equal(z[i], 0)) {
+                roots[n_roots++] = shift;
+            } else if (z[i] > 0) {
+                roots[n_roots++] = sqrt(z[i]) + shift;
+                roots[n_roots++] = -sqrt(z[i]) + shift;
+            }
+        }
+
+        return sort_unique_roots(roots, n_roots);
+    }
+
+    double factor_roots[4] = {};
+    int n_factor_roots = 0;
+
+    n_factor_roots = solve_square(1, -s, p / 2 + m + q / (2 * s), &factor_roots[0], &factor_roots[1]);
+    for (int i = 0; i < n_factor_roots; ++i) {
+        roots[n_roots++] = factor_roots[i] + shift;
+    }
+
+    n_factor_roots = solve_square(1, s, p / 2 + m - q / (2 * s), &factor_roots[2], &factor_roots[3]);
+    for (int i = 0; i < n_factor_roots; ++i) {
+        roots[n_roots++] = factor_roots[2 + i] + shift;
+    }
+
+    return sort_unique_roots(roots, n_roots);
+}
+
+/*!
+ * Sorts the roots in descending order and removes the almost equal ones
+ *
+ * @param roots [in, out] array of the roots
+ * @param n_roots [in] the number of roots
+ *
+ * @return the number of distinct roots
+ */
+int sort_unique_roots(double *roots, int n_roots)
+{
+    assert(roots != NULL);
+    assert(n_roots >= 0);
+
+    for (int i = 1; i < n_roots; ++i) {
+        double root = roots[i];
+
+        int j = i;
+        for (; (j > 0) && (roots[j - 1] < root); --j) {
+            roots[j] = roots[j - 1];
+        }
+
+        roots[j] = root;
+    }
+
+    int n_unique_roots = 0;
+
+    for (int i = 0; i < n_roots; ++i) {
+        if ((n_unique_roots == 0) || !are_almost_equal(roots[n_unique_roots - 1], roots[i])) {
+            roots[n_unique_roots++] = roots[i];
+        }
+    }
+
+    return n_unique_roots;
+}
+
+/*!
+ * Solves square equation ax^2 + bx + c = 0 like solve_square, but generically on the floating point type and so that
+ * it can be evaluated at compile time
+ *
+ * @param a [in] quadratic coefficient
+ * @param b [in] linear coefficient
+ * @param c [in] free term
+ * @param root1 [out] pointer to the greater root
+ * @param root2 [out] pointer to the lesser root
+ *
+ * @return the number of roots
+ *
+ * @note Returns INF_ROOTS in case of an infinite number of roots. The tolerance is defined by get_tolerance
+ * @note The roots may differ from the ones of solve_square in the last bit, because sqrt_constexpr is used
+ */
+template <typename T>
+constexpr int solve_square_constexpr(T a, T b, T c, T *root1, T *root2)
+{
+    assert(is_finite_constexpr(a));
+    assert(is_finite_constexpr(b));
+    assert(is_finite_constexpr(c));
+
+    assert(root1 != NULL);
+    assert(root2 != NULL);
+    assert(root1 != root2);
+
+    if (are_almost_equal_constexpr<T>(a, 0)) {
+        int n_roots = solve_linear_constexpr(b, c, root1);
+        *root2 = *root1;
+
+        return n_roots;
+    } else {
+        T d = b * b - 4 * a * c;
+        T parabola_vertex = -b / (2 * a);
+
+        if (are_almost_equal_constexpr<T>(d, 0)) {
+            *root1 = *root2 = parabola_vertex;
+
+            return 1;
+        } else if (d > 0) {
+            *root1 = parabola_vertex + sqrt_constexpr(d) / (2 * a);
+            *root2 = parabola_vertex - sqrt_constexpr(d) / (2 * a);
+
+            return 2;
+        } else {
+            return 0;
+        }
+    }
+}
+
+/*!
+ * Solves linear equation bx + c = 0 like solve_linear, but generically on the floating point type and so that it
+ * can be evaluated at compile time
+ *
+ * @param b [in] linear coefficient
+ * @param c [in] free term
+ * @param root [out] pointer to the root
+ *
+ * @return the number of roots
+ *
+ * @note Returns INF_ROOTS in case of an infinite number of roots
+ */
+template <typename T>
+constexpr int solve_linear_constexpr(T b, T c, T *root)
+{
+    assert(is_finite_constexpr(b));
+    assert(is_finite_constexpr(c));
+    assert(root != NULL);
+
+    if (are_almost_equal_constexpr<T>(b, 0)) {
+        return (are_almost_equal_constexpr<T>(c, 0)) ? INF_ROOTS : 0;
+    } else {
+        *root = -c / b;
+        return 1;
+    }
+}
+
+/*!
+ * Compares 2 floating point numbers like are_almost_equal, but so that it can be evaluated at compile time
+ *
+ * @param flt1 [in] first floating point number
+ * @param flt2 [in] second floating point number
+ *
+ * @return 1 if the numbers are almost equal, considering the tolerance, otherwise 0
+ */
+template <typename T>
+constexpr int are_almost_equal_constexpr(T flt1, T flt2)
+{
+    assert(is_finite_constexpr(flt1));
+    assert(is_finite_constexpr(flt2));
+
+    T difference = flt1 - flt2;
+
+    return (((difference < 0) ? -difference : difference) < get_tolerance<T>()) ? 1 : 0;
+}
+
+/*!
+ * Gets the tolerance for comparing floating point numbers of the type
+ *
+ * @return EPS_F for float, EPS for the other types
+ */
+template <typename T>
+constexpr T get_tolerance(void)
+{
+    return EPS;
+}
+
+template <>
+constexpr float get_tolerance<float>(void)
+{
+    return EPS_F;
+}
+
+/*!
+ * Checks that a floating point number is finite, so that it can be evaluated at compile time
+ *
+ * @param flt [in] floating point number
+ *
+ * @return 1 if the number is neither infinite nor NAN, otherwise 0
+ */
+template <typename T>
+constexpr int is_finite_constexpr(T flt)
+{
+    return (flt - flt == 0) ? 1 : 0;
+}
+
+/*!
+ * Computes the square root of a floating point number by Newton's method, so that it can be evaluated at compile time
+ *
+ * @param flt [in] non-negative finite floating point number
+ *
+ * @return the square root, which differs from the one of sqrt by at most 1 ulp
+ *
+ * @note The iterations start above the square root and decrease monotonically, so they stop when they don't decrease
+ */
+template <typename T>
+constexpr T sqrt_constexpr(T flt)
+{
+    assert(is_finite_constexpr(flt));
+    assert(flt >= 0);
+
+    if (flt == 0) {
+        return 0;
+    }
+
+    T root = (flt > 1) ? flt : 1;
+
+    while (true) {
+        T next_root = (root + flt / root) / 2;
+
+        if (next_root >= root) {
+            return root;
+        }
+
+        root = next_root;
+    }
+}
+
+/*!
+ * Builds the table of the roots of square equations over a grid of coefficients at compile time
+ *
+ * @param a [in] array of quadratic coefficients of the grid
+ * @param b [in] array of linear coefficients of the grid
+ * @param c [in] array of free terms of the grid
+ *
+ * @return the table of the roots
+ *
+ * @note Should be used to initialize a constexpr variable, e.g. so that embedded targets need no initialization
+ */
+template <typename T, size_t N_A, size_t N_B, size_t N_C>
+constexpr square_root_table_t<T, N_A, N_B, N_C> make_square_root_table(const T (&a)[N_A], const T (&b)[N_B],
+                                                                      const T (&c)[N_C])
+{
+    square_root_table_t<T, N_A, N_B, N_C> table = {};
+
+    for (size_t i_a = 0; i_a < N_A; ++i_a) {
+        for (size_t i_b = 0; i_b < N_B; ++i_b) {
+            for (size_t i_c = 0; i_c < N_C; ++i_c) {
+                square_roots_t<T> &entry = table.entries[(i_a * N_B + i_b) * N_C + i_c];
+
+                entry.n_roots = solve_square_constexpr(a[i_a], b[i_b], c[i_c], &entry.root1, &entry.root2);
+            }
+        }
+    }
+
+    return table;
+}
+
+/*!
+ * Solves square equation ax^2 + bx + c = 0 in single precision and saves its roots
+ *
+ * @param a [in] quadratic coefficient
+ * @param b [in] linear coefficient
+ * @param c [in] free term
+ * @param root1 [out] pointer to the greater root
+ * @param root2 [out] pointer to the lesser root
+ *
+ * @return the number of roots
+ *
+ * @note Returns INF_ROOTS in case of an infinite number of roots. The tolerance is defined by EPS_F
+ */
+int solve_square_f(float a, float b, float c, float *root1, float *root2)
+{
+    assert(isfinite(a));
+    assert(isfinite(b));
+    assert(isfinite(c));
+
+    assert(root1 != NULL);
+    assert(root2 != NULL);
+    assert(root1 != root2);
+
+    if (are_almost_equal_f(a, 0)) {
+        int n_roots = solve_linear_f(b, c, root1);
+        *root2 = *root1;
+
+        return n_roots;
+    } else {
+        float d = b * b - 4 * a * c;
+        float parabola_vertex = -b / (2 * a);
+
+        if (are_almost_equal_f(d, 0)) {
+            *root1 = *root2 = parabola_vertex;
+
+            return 1;
+        } else if (d > 0) {
+            *root1 = parabola_vertex + sqrtf(d) / (2 * a);
+            *root2 = parabola_vertex - sqrtf(d) / (2 * a);
+
+            return 2;
+        } else {
+            return 0;
+        }
+    }
+}
+
+/*!
+ * Solves linear equation bx + c = 0 in single precision and saves its root
+ *
+ * @param b [in] linear coefficient
+ * @param c [in] free term
+ * @param root [out] pointer to the root
+ *
+ * @return the number of roots
+ *
+ * @note Returns INF_ROOTS in case of an infinite number of roots
+ */
+int solve_linear_f(float b, float c, float *root)
+{
+    assert(isfinite(b));
+    assert(isfinite(c));
+    assert(root != NULL);
+
+    if (are_almost_equal_f(b, 0)) {
+        return (are_almost_equal_f(c, 0)) ? INF_ROOTS : 0;
+    } else {
+        *root = -c / b;
+        return 1;
+    }
+}
+
+/*!
+ * Compares 2 single precision floating point numbers
+ *
+ * @param flt1 [in] first single precision floating point number
+ * @param flt2 [in] second single precision floating point number
+ *
+ * @return 1 if the numbers are almost equal, considering the tolerance, otherwise 0
+ *
+ * @note The tolerance is EPS_F relative to the greater magnitude of the numbers, but not less than EPS_F, so that
+ * comparing with 0 is the same as with an absolute tolerance
+ */
+int are_almost_equal_f(float flt1, float flt2)
+{
+    assert(isfinite(flt1));
+    assert(isfinite(flt2));
+
+    float magnitude = fmaxf(1, fmaxf(fabsf(flt1), fabsf(flt2)));
+
+    return (fabsf(flt1 - flt2) < EPS_F * magnitude) ? 1 : 0;
+}
+
+/*!
+ * Solves n square equations a[i]x^2 + b[i]x + c[i] = 0, given as structure of arrays, using the fastest kernel
+ * supported by the CPU. The results are the same as of solve_square called for each equation
+ *
+ * @param a [in] array of quadratic coefficients
+ * @param b [in] array of linear coefficients
+ * @param c [in] array of free terms
+ * @param n [in] the number of equations
+ * @param n_roots [out] array of the numbers of roots
+ * @param root1 [out] array of the greater roots
+ * @param root2 [out] array of the lesser roots
+ *
+ * @note The roots of equations with 0 or INF_ROOTS roots are set to 0
+ */
+void solve_square_batch(const double *a, const double *b, const double *c, size_t n,
+                        int *n_roots, double *root1, double *root2)
+{
+    assert(a != NULL);
+    assert(b != NULL);
+    assert(c != NULL);
+
+    assert(n_roots != NULL);
+    assert(root1 != NULL);
+    assert(root2 != NULL);
+    assert(root1 != root2);
+
+    static solve_square_batch_kernel_t *kernel = select_solve_square_batch_kernel();
+
+    (*kernel)(a, b, c, n, n_roots, root1, root2);
+}
+
+/*!
+ * Selects the fastest solve_square_batch kernel supported by the CPU
+ *
+ * @return pointer to the kernel
+ */
+solve_square_batch_kernel_t *select_solve_square_batch_kernel(void)
+{
+#ifdef SOLVE_SQUARE_X86_KERNELS
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f")) {
+        return solve_square_batch_avx512;
+    }
+
+    if (__builtin_cpu_supports("avx2")) {
+        return solve_square_batch_avx2;
+    }
+
+    if (__builtin_cpu_supports("sse2")) {
+        return solve_square_batch_sse2;
+    }
+#endif
+
+    return solve_square_batch_scalar;
+}
+
+/*!
+ * Portable solve_square_batch kernel, which is also used for the tails of the vectorized kernels
+ */
+void solve_square_batch_scalar(const double *a, const double *b, const double *c, size_t n,
+                               int *n_roots, double *root1, double *root2)
+{
+    for (size_t i = 0; i < n; ++i) {
+        root1[i] = root2[i] = 0;
+
+        n_roots[i] = solve_square(a[i], b[i], c[i], &root1[i], &root2[i]);
+    }
+}
+
+/*!
+ * Solves n square equations like solve_square_batch, using multiple threads. The equations are split into blocks
+ * of PARALLEL_BLOCK_SIZE, which threads take one by one from a shared counter, so that faster threads take more
+ * blocks. The results don't depend on the number of threads
+ *
+ * @param a [in] array of quadratic coefficients
+ * @param b [in] array of linear coefficients
+ * @param c [in] array of free terms
+ * @param n [in] the number of equations
+ * @param n_roots [out] array of the numbers of roots
+ * @param root1 [out] array of the greater roots
+ * @param root2 [out] array of the lesser roots
+ * @param n_threads [in] the number of threads or 0 for using all hardware threads
+ * @param stats [out] pointer to the root count statistics or NULL
+ */
+void solve_square_batch_parallel(const double *a, const double *b, const double *c, size_t n,
+                                 int *n_roots, double *root1, double *root2,
+                                 size_t n_threads, root_count_stats_t *stats)
+{
+    if (n_threads == 0) {
+        n_threads = std::thread::hardware_concurrency();
+    }
+
+    size_t n_blocks = (n + PARALLEL_BLOCK_SIZE - 1) / PARALLEL_BLOCK_SIZE;
+
+    if (n_threads > n_blocks) {
+        n_threads = n_blocks;
+    }
+
+    if (n_threads == 0) {
+        n_threads = 1;
+    }
+
+    std::atomic<size_t> next_block(0);
+
+    std::vector<thread_root_count_stats_t> thread_stats(n_threads);
+
+    auto solve_blocks = [&](size_t thread_i) {
+        for (size_t block = next_block++; block < n_blocks; block = next_block++) {
+            size_t begin = block * PARALLEL_BLOCK_SIZE,
+                   size  = (n - begin < PARALLEL_BLOCK_SIZE) ? n - begin : PARALLEL_BLOCK_SIZE;
+
+            solve_square_batch(a + begin, b + begin, c + begin, size, n_roots + begin, root1 + begin, root2 + begin);
+
+            if (stats != NULL) {
+                count_roots(n_roots + begin, size, &thread_stats[thread_i].stats);
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+
+    for (size_t i = 1; i < n_threads; ++i) {
+        threads.emplace_back(solve_blocks, i);
+    }
+
+    solve_blocks(0);
+
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    if (stats != NULL) {
+        *stats = {};
+
+        for (const thread_root_count_stats_t &thread_stat : thread_stats) {
+            stats->n_no_roots  += thread_stat.stats.n_no_roots;
+            stats->n_one_root  += thread_stat.stats.n_one_root;
+            stats->n_two_roots += thread_stat.stats.n_two_roots;
+            stats->n_inf_roots += thread_stat.stats.n_inf_roots;
+        }
+    }
+}
+
+/*!
+ * Adds the numbers of equations for each number of roots to the root count statistics
+ *
+ * @param n_roots [in] array of the numbers of roots
+ * @param n [in] the number of equations
+ * @param stats [in, out] pointer to the root count statistics
+ */
+void count_roots(const int *n_roots, size_t n, root_count_stats_t *stats)
+{
+    assert(n_roots != NULL);
+    assert(stats != NULL);
+
+    size_t counts[4] = {};
+
+    for (size_t i = 0; i < n; ++i) {
+        ++counts[(n_roots[i] == INF_ROOTS) ? 3 : n_roots[i]];
+    }
+
+    stats->n_no_roots  += counts[0];
+    stats->n_one_root  += counts[1];
+    stats->n_two_roots += counts[2];
+    stats->n_inf_roots += counts[3];
+}
+
+/*!
+ * Classifies n square equations like classify_square, using the fastest kernel supported by the CPU. Only the
+ * discriminants and the degenerate coefficient tests are computed, without divisions and square roots
+ *
+ * @param a [in] array of quadratic coefficients
+ * @param b [in] array of linear coefficients
+ * @param c [in] array of free terms
+ * @param n [in] the number of equations
+ * @param n_roots [out] array of the numbers of roots or NULL, if only the statistics are needed
+ * @param stats [out] pointer to the root count statistics or NULL
+ */
+void classify_square_batch(const double *a, const double *b, const double *c, size_t n,
+                           int *n_roots, root_count_stats_t *stats)
+{
+    assert(a != NULL);
+    assert(b != NULL);
+    assert(c != NULL);
+
+    static classify_square_batch_kernel_t *kernel = select_classify_square_batch_kernel();
+
+    if (stats != NULL) {
+        *stats = {};
+    }
+
+    if (n_roots != NULL) {
+        (*kernel)(a, b, c, n, n_roots);
+
+        if (stats != NULL) {
+            count_roots(n_roots, n, stats);
+        }
+
+        return;
+    }
+
+    if (stats == NULL) {
+        return;
+    }
+
+    int block_n_roots[PARALLEL_BLOCK_SIZE] = {};
+
+    for (size_t begin = 0; begin < n; begin += PARALLEL_BLOCK_SIZE) {
+        size_t size = (n - begin < PARALLEL_BLOCK_SIZE) ? n - begin : PARALLEL_BLOCK_SIZE;
+
+        (*kernel)(a + begin, b + begin, c + begin, size, block_n_roots);
+
+        count_roots(block_n_roots, size, stats);
+    }
+}
+
+/*!
+ * Selects the fastest classify_square_batch kernel supported by the CPU
+ *
+ * @return pointer to the kernel
+ */
+classify_square_batch_kernel_t *select_classify_square_batch_kernel(void)
+{
+#ifdef SOLVE_SQUARE_X86_KERNELS
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f")) {
+        return classify_square_batch_avx512;
+    }
+
+    if (__builtin_cpu_supports("avx2")) {
+        return classify_square_batch_avx2;
+    }
+
+    if (__builtin_cpu_supports("sse2")) {
+        return classify_square_batch_sse2;
+    }
+#endif
+
+    return classify_square_batch_scalar;
+}
+
+/*!
+ * Portable classify_square_batch kernel, which is also used for the tails of the vectorized kernels
+ */
+void classify_square_batch_scalar(const double *a, const double *b, const double *c, size_t n, int *n_roots)
+{
+    for (size_t i = 0; i < n; ++i) {
+        n_roots[i] = classify_square(a[i], b[i], c[i]);
+    }
+}
+
+/*!
+ * Solves n cubic equations like solve_cubic, taking the coefficients and saving the roots as structures of arrays
+ *
+ * @param a [in] array of cubic coefficients
+ * @param b [in] array of quadratic coefficients
+ * @param c [in] array of linear coefficients
+ * @param d [in] array of free terms
+ * @param n [in] the number of equations
+ * @param n_roots [out] array of the numbers of roots
+ * @param root1 [out] array of the greatest roots
+ * @param root2 [out] array of the second roots
+ * @param root3 [out] array of the least roots
+ *
+ * @note The roots which an equation doesn't have are set to NAN
+ */
+void solve_cubic_batch(const double *a, const double *b, const double *c, const double *d, size_t n,
+                       int *n_roots, double *root1, double *root2, double *root3)
+{
+    assert(a != NULL);
+    assert(b != NULL);
+    assert(c != NULL);
+    assert(d != NULL);
+
+    assert(n_roots != NULL);
+    assert(root1 != NULL);
+    assert(root2 != NULL);
+    assert(root3 != NULL);
+
+    for (size_t i = 0; i < n; ++i) {
+        double roots[3] = {NAN, NAN, NAN};
+        n_roots[i] = solve_cubic(a[i], b[i], c[i], d[i], roots);
+
+        for (int k = (n_roots[i] == INF_ROOTS) ? 0 : n_roots[i]; k < 3; ++k) {
+            roots[k] = NAN;
+        }
+
+        root1[i] = roots[0];
+        root2[i] = roots[1];
+        root3[i] = roots[2];
+    }
+}
+
+/*!
+ * Solves n quartic equations like solve_quartic, taking the coefficients and saving the roots as structures of arrays
+ *
+ * @param a [in] array of quartic coefficients
+ * @param b [in] array of cubic coefficients
+ * @param c [in] array of quadratic coefficients
+ * @param d [in] array of linear coefficients
+ * @param e [in] array of free terms
+ * @param n [in] the number of equations
+ * @param n_roots [out] array of the numbers of roots
+ * @param root1 [out] array of the greatest roots
+ * @param root2 [out] array of the second roots
+ * @param root3 [out] array of the third roots
+ * @param root4 [out] array of the least roots
+ *
+ * @note The roots which an equation doesn't have are set to NAN
+ */
+void solve_quartic_batch(const double *a, const double *b, const double *c, const double *d, const double *e, size_t n,
+                         int *n_roots, double *root1, double *root2, double *root3, double *root4)
+{
+    assert(a != NULL);
+    assert(b != NULL);
+    assert(c != NULL);
+    assert(d != NULL);
+    assert(e != NULL);
+
+    assert(n_roots != NULL);
+    assert(root1 != NULL);
+    assert(root2 != NULL);
+    assert(root3 != NULL);
+    assert(root4 != NULL);
+
+    for (size_t i = 0; i < n; ++i) {
+        double roots[4] = {NAN, NAN, NAN, NAN};
+        n_roots[i] = solve_quartic(a[i], b[i], c[i], d[i], e[i], roots);
+
+        for (int k = (n_roots[i] == INF_ROOTS) ? 0 : n_roots[i]; k < 4; ++k) {
+            roots[k] = NAN;
+        }
+
+        root1[i] = roots[0];
+        root2[i] = roots[1];
+        root3[i] = roots[2];
+        root4[i] = roots[3];
+    }
+}
+
+/*!
+ * Solves n square equations like solve_square_batch in single precision, processing twice as many equations at a
+ * time. The results are the same as of solve_square_f called for each equation
+ *
+ * @param a [in] array of quadratic coefficients
+ * @param b [in] array of linear coefficients
+ * @param c [in] array of free terms
+ * @param n [in] the number of equations
+ * @param n_roots [out] array of the numbers of roots
+ * @param root1 [out] array of the greater roots
+ * @param root2 [out] array of the lesser roots
+ *
+ * @note The roots of equations with 0 or INF_ROOTS roots are set to 0
+ */
+void solve_square_batch_f(const float *a, const float *b, const float *c, size_t n,
+                          int *n_roots, float *root1, float *root2)
+{
+    assert(a != NULL);
+    assert(b != NULL);
+    assert(c != NULL);
+
+    assert(n_roots != NULL);
+    assert(root1 != NULL);
+    assert(root2 != NULL);
+    assert(root1 != root2);
+
+    static solve_square_batch_f_kernel_t *kernel = select_solve_square_batch_f_kernel();
+
+    (*kernel)(a, b, c, n, n_roots, root1, root2);
+}
+
+/*!
+ * Selects the fastest solve_square_batch_f kernel supported by the CPU
+ *
+ * @return pointer to the kernel
+ */
+solve_square_batch_f_kernel_t *select_solve_square_batch_f_kernel(void)
+{
+#ifdef SOLVE_SQUARE_X86_KERNELS
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f")) {
+        return solve_square_batch_f_avx512;
+    }
+
+    if (__builtin_cpu_supports("avx2")) {
+        return solve_square_batch_f_avx2;
+    }
+
+    if (__builtin_cpu_supports("sse2")) {
+        return solve_square_batch_f_sse2;
+    }
+#endif
+
+    return solve_square_batch_f_scalar;
+}
+
+/*!
+ * Portable solve_square_batch_f kernel, which is also used for the tails of the vectorized kernels
+ */
+void solve_square_batch_f_scalar(const float *a, const float *b, const float *c, size_t n,
+                                 int *n_roots, float *root1, float *root2)
+{
+    for (size_t i = 0; i < n; ++i) {
+        root1[i] = root2[i] = 0;
+
+        n_roots[i] = solve_square_f(a[i], b[i], c[i], &root1[i], &root2[i]);
+    }
+}
+
+/*!
+ * Solves n square equations like solve_square_batch in mixed precision: the equations are solved in single
+ * precision, and only the ill-conditioned ones are solved again in double precision. The numbers of roots are the
+ * same as of solve_square, and the roots have single precision accuracy
+ *
+ * @param a [in] array of quadratic coefficients
+ * @param b [in] array of linear coefficients
+ * @param c [in] array of free terms
+ * @param n [in] the number of equations
+ * @param n_roots [out] array of the numbers of roots
+ * @param root1 [out] array of the greater roots
+ * @param root2 [out] array of the lesser roots
+ *
+ * @note The roots of equations with 0 or INF_ROOTS roots are set to 0
+ */
+void solve_square_batch_mixed(const double *a, const double *b, const double *c, size_t n,
+                              int *n_roots, double *root1, double *root2)
+{
+    assert(a != NULL);
+    assert(b != NULL);
+    assert(c != NULL);
+
+    assert(n_roots != NULL);
+    assert(root1 != NULL);
+    assert(root2 != NULL);
+    assert(root1 != root2);
+
+    float a_f[MIXED_BLOCK_SIZE] = {}, b_f[MIXED_BLOCK_SIZE] = {}, c_f[MIXED_BLOCK_SIZE] = {},
+          root1_f[MIXED_BLOCK_SIZE] = {}, root2_f[MIXED_BLOCK_SIZE] = {};
+
+    int is_ill_conditioned[MIXED_BLOCK_SIZE] = {};
+
+    for (size_t begin = 0; begin < n; begin += MIXED_BLOCK_SIZE) {
+        size_t size = (n - begin < MIXED_BLOCK_SIZE) ? n - begin : MIXED_BLOCK_SIZE;
+
+        for (size_t i = 0; i < size; ++i) {
+            a_f[i] = (float) a[begin + i];
+            b_f[i] = (float) b[begin + i];
+            c_f[i] = (float) c[begin + i];
+
+            is_ill_conditioned[i] = is_ill_conditioned_f(a_f[i], b_f[i], c_f[i]);
+
+            if (is_ill_conditioned[i]) {
+                a_f[i] = b_f[i] = c_f[i] = 0;
+            }
+        }
+
+        solve_square_batch_f(a_f, b_f, c_f, size, n_roots + begin, root1_f, root2_f);
+
+        for (size_t i = 0; i < size; ++i) {
+            if (is_ill_conditioned[i]) {
+                root1[begin + i] = root2[begin + i] = 0;
+
+                n_roots[begin + i] = solve_square(a[begin + i], b[begin + i], c[begin + i],
+                                                  &root1[begin + i], &root2[begin + i]);
+            } else {
+                root1[begin + i] = root1_f[i];
+                root2[begin + i] = root2_f[i];
+            }
+        }
+    }
+}
+
+/*!
+ * Checks whether square equation ax^2 + bx + c = 0 is ill-conditioned in single precision: its coefficients are out
+ * of single precision range, it's close to linear, its discriminant is too close to 0 to be sure about the number of
+ * roots, or its lesser root loses too much precision to cancellation
+ *
+ * @param a [in] quadratic coefficient, converted to single precision
+ * @param b [in] linear coefficient, converted to single precision
+ * @param c [in] free term, converted to single precision
+ *
+ * @return 1 if the equation must be solved in double precision, otherwise 0
+ *
+ * @note The coefficients may be infinite, if they didn't fit in single precision
+ */
+int is_ill_conditioned_f(float a, float b, float c)
+{
+    float b_squared = b * b,
+          four_ac   = fabsf(4 * a * c),
+          d         = b_squared - 4 * a * c;
+
+    return !(fabsf(a) + fabsf(b) + fabsf(c) <= FLT_MAX) || !(b_squared + four_ac <= FLT_MAX) ||
+           are_almost_equal_f(a, 0) || are_almost_equal_f(d, 0) ||
+           (fabsf(d) <= MIXED_REFINE_FACTOR * FLT_EPSILON * (b_squared + four_ac)) ||
+           (b_squared > MIXED_MAX_CANCELLATION * four_ac);
+}
+
+#ifdef SOLVE_SQUARE_X86_KERNELS
+
+/*
+ * The vectorized kernels compute every branch of solve_square for all lanes and select the results by masks, in
+ * the same order of operations as solve_square, so that their results are bitwise equal to the scalar ones.
+ * Lanes of the discarded branches may hold infinities or NaNs from dividing by zero, which are never selected
+ */
+
+/*!
+ * SSE2 solve_square_batch kernel, processes 2 equations at a time
+ */
+__attribute__((target("sse2")))
+void solve_square_batch_sse2(const double *a, const double *b, const double *c, size_t n,
+                             int *n_roots, double *root1, double *root2)
+{
+    const __m128d sign_mask = _mm_set1_pd(-0.0),
+                  eps       = _mm_set1_pd(EPS),
+                  zero      = _mm_setzero_pd(),
+                  one       = _mm_set1_pd(1),
+                  two       = _mm_set1_pd(2),
+                  four      = _mm_set1_pd(4),
+                  inf_roots = _mm_set1_pd(INF_ROOTS);
+
+#define SELECT(mask, if_true, if_false) _mm_or_pd(_mm_and_pd((mask), (if_true)), _mm_andnot_pd((mask), (if_false)))
+#define IS_ALMOST_ZERO(x) _mm_cmplt_pd(_mm_andnot_pd(sign_mask, (x)), eps)
+
+    size_t i = 0;
+
+    for (; i + 2 <= n; i += 2) {
+        __m128d va = _mm_loadu_pd(a + i),
+                vb = _mm_loadu_pd(b + i),
+                vc = _mm_loadu_pd(c + i);
+
+        __m128d is_linear = IS_ALMOST_ZERO(va),
+                b_is_zero = IS_ALMOST_ZERO(vb),
+                c_is_zero = IS_ALMOST_ZERO(vc);
+
+        __m128d linear_root    = _mm_div_pd(_mm_xor_pd(vc, sign_mask), vb),
+                linear_n_roots = SELECT(b_is_zero, SELECT(c_is_zero, inf_roots, zero), one);
+
+        linear_root = SELECT(b_is_zero, zero, linear_root);
+
+        __m128d two_a  = _mm_mul_pd(two, va),
+                d      = _mm_sub_pd(_mm_mul_pd(vb, vb), _mm_mul_pd(_mm_mul_pd(four, va), vc)),
+                vertex = _mm_div_pd(_mm_xor_pd(vb, sign_mask), two_a),
+                offset = _mm_div_pd(_mm_sqrt_pd(d), two_a);
+
+        __m128d d_is_zero   = IS_ALMOST_ZERO(d),
+                d_is_positive = _mm_andnot_pd(d_is_zero, _mm_cmpgt_pd(d, zero));
+
+        __m128d quadratic_n_roots = SELECT(d_is_zero, one, SELECT(d_is_positive, two, zero)),
+                quadratic_root1   = SELECT(d_is_zero, vertex,
+                                           SELECT(d_is_positive, _mm_add_pd(vertex, offset), zero)),
+                quadratic_root2   = SELECT(d_is_zero, vertex,
+                                           SELECT(d_is_positive, _mm_sub_pd(vertex, offset), zero));
+
+        _mm_storel_epi64((__m128i *) (n_roots + i),
+                         _mm_cvttpd_epi32(SELECT(is_linear, linear_n_roots, quadratic_n_roots)));
+
+        _mm_storeu_pd(root1 + i, SELECT(is_linear, linear_root, quadratic_root1));
+        _mm_storeu_pd(root2 + i, SELECT(is_linear, linear_root, quadratic_root2));
+    }
+
+#undef IS_ALMOST_ZERO
+#undef SELECT
+
+    solve_square_batch_scalar(a + i, b + i, c + i, n - i, n_roots + i, root1 + i, root2 + i);
+}
+
+/*!
+ * AVX2 solve_square_batch kernel, processes 4 equations at a time
+ */
+__attribute__((target("avx2")))
+void solve_square_batch_avx2(const double *a, const double *b, const double *c, size_t n,
+                             int *n_roots, double *root1, double *root2)
+{
+    const __m256d sign_mask = _mm256_set1_pd(-0.0),
+                  eps       = _mm256_set1_pd(EPS),
+                  zero      = _mm256_setzero_pd(),
+                  one       = _mm256_set1_pd(1),
+                  two       = _mm256_set1_pd(2),
+                  four      = _mm256_set1_pd(4),
+                  inf_roots = _mm256_set1_pd(INF_ROOTS);
+
+#define SELECT(mask, if_true, if_false) _mm256_blendv_pd((if_false), (if_true), (mask))
+#define IS_ALMOST_ZERO(x) _mm256_cmp_pd(_mm256_andnot_pd(sign_mask, (x)), eps, _CMP_LT_OQ)
+
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m256d va = _mm256_loadu_pd(a + i),
+                vb = _mm256_loadu_pd(b + i),
+                vc = _mm256_loadu_pd(c + i);
+
+        __m256d is_linear = IS_ALMOST_ZERO(va),
+                b_is_zero = IS_ALMOST_ZERO(vb),
+                c_is_zero = IS_ALMOST_ZERO(vc);
+
+        __m256d linear_root    = _mm256_div_pd(_mm256_xor_pd(vc, sign_mask), vb),
+                linear_n_roots = SELECT(b_is_zero, SELECT(c_is_zero, inf_roots, zero), one);
+
+        linear_root = SELECT(b_is_zero, zero, linear_root);
+
+        __m256d two_a  = _mm256_mul_pd(two, va),
+                d      = _mm256_sub_pd(_mm256_mul_pd(vb, vb), _mm256_mul_pd(_mm256_mul_pd(four, va), vc)),
+                vertex = _mm256_div_pd(_mm256_xor_pd(vb, sign_mask), two_a),
+                offset = _mm256_div_pd(_mm256_sqrt_pd(d), two_a);
+
+        __m256d d_is_zero     = IS_ALMOST_ZERO(d),
+                d_is_positive = _mm256_andnot_pd(d_is_zero, _mm256_cmp_pd(d, zero, _CMP_GT_OQ));
+
+        __m256d quadratic_n_roots = SELECT(d_is_zero, one, SELECT(d_is_positive, two, zero)),
+                quadratic_root1   = SELECT(d_is_zero, vertex,
+                                           SELECT(d_is_positive, _mm256_add_pd(vertex, offset), zero)),
+                quadratic_root2   = SELECT(d_is_zero, vertex,
+                                           SELECT(d_is_positive, _mm256_sub_pd(vertex, offset), zero));
+
+        _mm_storeu_si128((__m128i *) (n_roots + i),
+                         _mm256_cvttpd_epi32(SELECT(is_linear, linear_n_roots, quadratic_n_roots)));
+
+        _mm256_storeu_pd(root1 + i, SELECT(is_linear, linear_root, quadratic_root1));
+        _mm256_storeu_pd(root2 + i, SELECT(is_linear, linear_root, quadratic_root2));
+    }
+
+#undef IS_ALMOST_ZERO
+#undef SELECT
+
+    solve_square_batch_scalar(a + i, b + i, c + i, n - i, n_roots + i, root1 + i, root2 + i);
+}
+
+/*!
+ * AVX-512 solve_square_batch kernel, processes 8 equations at a time
+ */
+__attribute__((target("avx512f")))
+void solve_square_batch_avx512(const double *a, const double *b, const double *c, size_t n,
+                               int *n_roots, double *root1, double *root2)
+{
+    const __m512i sign_mask = _mm512_set1_epi64((long long) 0x8000000000000000ULL);
+
+    /* Zero-masked forms over all lanes are used, the unmasked ones trip GCC's false -Wmaybe-uninitialized */
+    const __mmask8 all_lanes = 0xFF;
+
+    const __m512d eps       = _mm512_set1_pd(EPS),
+                  zero      = _mm512_setzero_pd(),
+                  one       = _mm512_set1_pd(1),
+                  two       = _mm512_set1_pd(2),
+                  four      = _mm512_set1_pd(4),
+                  inf_roots = _mm512_set1_pd(INF_ROOTS);
+
+#define SELECT(mask, if_true, if_false) _mm512_mask_blend_pd((mask), (if_false), (if_true))
+#define IS_ALMOST_ZERO(x) _mm512_cmp_pd_mask(_mm512_abs_pd(x), eps, _CMP_LT_OQ)
+#define NEGATE(x) _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(x), sign_mask))
+
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m512d va = _mm512_loadu_pd(a + i),
+                vb = _mm512_loadu_pd(b + i),
+                vc = _mm512_loadu_pd(c + i);
+
+        __mmask8 is_linear = IS_ALMOST_ZERO(va),
+                 b_is_zero = IS_ALMOST_ZERO(vb),
+                 c_is_zero = IS_ALMOST_ZERO(vc);
+
+        __m512d linear_root    = _mm512_div_pd(NEGATE(vc), vb),
+                linear_n_roots = SELECT(b_is_zero, SELECT(c_is_zero, inf_roots, zero), one);
+
+        linear_root = SELECT(b_is_zero, zero, linear_root);
+
+        __m512d two_a  = _mm512_mul_pd(two, va),
+                d      = _mm512_sub_pd(_mm512_mul_pd(vb, vb), _mm512_mul_pd(_mm512_mul_pd(four, va), vc)),
+                vertex = _mm512_div_pd(NEGATE(vb), two_a),
+                offset = _mm512_div_pd(_mm512_maskz_sqrt_pd(all_lanes, d), two_a);
+
+        __mmask8 d_is_zero     = IS_ALMOST_ZERO(d),
+                 d_is_positive = (__mmask8) (~d_is_zero & _mm512_cmp_pd_mask(d, zero, _CMP_GT_OQ));
+
+        __m512d quadratic_n_roots = SELECT(d_is_zero, one, SELECT(d_is_positive, two, zero)),
+                quadratic_root1   = SELECT(d_is_zero, vertex,
+                                           SELECT(d_is_positive, _mm512_add_pd(vertex, offset), zero)),
+                quadratic_root2   = SELECT(d_is_zero, vertex,
+                                           SELECT(d_is_positive, _mm512_sub_pd(vertex, offset), zero));
+
+        _mm256_storeu_si256((__m256i *) (n_roots + i),
+                            _mm512_maskz_cvttpd_epi32(all_lanes, SELECT(is_linear, linear_n_roots, quadratic_n_roots)));
+
+        _mm512_storeu_pd(root1 + i, SELECT(is_linear, linear_root, quadratic_root1));
+        _mm512_storeu_pd(root2 + i, SELECT(is_linear, linear_root, quadratic_root2));
+    }
+
+#undef NEGATE
+#undef IS_ALMOST_ZERO
+#undef SELECT
+
+    solve_square_batch_scalar(a + i, b + i, c + i, n - i, n_roots + i, root1 + i, root2 + i);
+}
+
+/*!
+ * SSE2 classify_square_batch kernel, processes 2 equations at a time
+ */
+__attribute__((target("sse2")))
+void classify_square_batch_sse2(const double *a, const double *b, const double *c, size_t n, int *n_roots)
+{
+    const __m128d sign_mask = _mm_set1_pd(-0.0),
+                  eps       = _mm_set1_pd(EPS),
+                  zero      = _mm_setzero_pd(),
+                  one       = _mm_set1_pd(1),
+                  two       = _mm_set1_pd(2),
+                  four      = _mm_set1_pd(4),
+                  inf_roots = _mm_set1_pd(INF_ROOTS);
+
+#define SELECT(mask, if_true, if_false) _mm_or_pd(_mm_and_pd((mask), (if_true)), _mm_andnot_pd((mask), (if_false)))
+#define IS_ALMOST_ZERO(x) _mm_cmplt_pd(_mm_andnot_pd(sign_mask, (x)), eps)
+
+    size_t i = 0;
+
+    for (; i + 2 <= n; i += 2) {
+        __m128d va = _mm_loadu_pd(a + i),
+                vb = _mm_loadu_pd(b + i),
+                vc = _mm_loadu_pd(c + i);
+
+        __m128d d = _mm_sub_pd(_mm_mul_pd(vb, vb), _mm_mul_pd(_mm_mul_pd(four, va), vc));
+
+        __m128d linear_n_roots    = SELECT(IS_ALMOST_ZERO(vb), SELECT(IS_ALMOST_ZERO(vc), inf_roots, zero), one),
+                quadratic_n_roots = SELECT(IS_ALMOST_ZERO(d), one, SELECT(_mm_cmpgt_pd(d, zero), two, zero));
+
+        _mm_storel_epi64((__m128i *) (n_roots + i),
+                         _mm_cvttpd_epi32(SELECT(IS_ALMOST_ZERO(va), linear_n_roots, quadratic_n_roots)));
+    }
+
+#undef IS_ALMOST_ZERO
+#undef SELECT
+
+    classify_square_batch_scalar(a + i, b + i, c + i, n - i, n_roots + i);
+}
+
+/*!
+ * AVX2 classify_square_batch kernel, processes 4 equations at a time
+ */
+__attribute__((target("avx2")))
+void classify_square_batch_avx2(const double *a, const double *b, const double *c, size_t n, int *n_roots)
+{
+    const __m256d sign_mask = _mm256_set1_pd(-0.0),
+                  eps       = _mm256_set1_pd(EPS),
+                  zero      = _mm256_setzero_pd(),
+                  one       = _mm256_set1_pd(1),
+                  two       = _mm256_set1_pd(2),
+                  four      = _mm256_set1_pd(4),
+                  inf_roots = _mm256_set1_pd(INF_ROOTS);
+
+#define SELECT(mask, if_true, if_false) _mm256_blendv_pd((if_false), (if_true), (mask))
+#define IS_ALMOST_ZERO(x) _mm256_cmp_pd(_mm256_andnot_pd(sign_mask, (x)), eps, _CMP_LT_OQ)
+
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m256d va = _mm256_loadu_pd(a + i),
+                vb = _mm256_loadu_pd(b + i),
+                vc = _mm256_loadu_pd(c + i);
+
+        __m256d d = _mm256_sub_pd(_mm256_mul_pd(vb, vb), _mm256_mul_pd(_mm256_mul_pd(four, va), vc));
+
+        __m256d linear_n_roots    = SELECT(IS_ALMOST_ZERO(vb), SELECT(IS_ALMOST_ZERO(vc), inf_roots, zero), one),
+                quadratic_n_roots = SELECT(IS_ALMOST_ZERO(d), one,
+                                           SELECT(_mm256_cmp_pd(d, zero, _CMP_GT_OQ), two, zero));
+
+        _mm_storeu_si128((__m128i *) (n_roots + i),
+                         _mm256_cvttpd_epi32(SELECT(IS_ALMOST_ZERO(va), linear_n_roots, quadratic_n_roots)));
+    }
+
+#undef IS_ALMOST_ZERO
+#undef SELECT
+
+    classify_square_batch_scalar(a + i, b + i, c + i, n - i, n_roots + i);
+}
+
+/*!
+ * AVX-512 classify_square_batch kernel, processes 8 equations at a time
+ */
+__attribute__((target("avx512f")))
+void classify_square_batch_avx512(const double *a, const double *b, const double *c, size_t n, int *n_roots)
+{
+    /* See solve_square_batch_avx512 for the zero-masked conversion */
+    const __mmask8 all_lanes = 0xFF;
+
+    const __m512d eps       = _mm512_set1_pd(EPS),
+                  zero      = _mm512_setzero_pd(),
+                  one       = _mm512_set1_pd(1),
+                  two       = _mm512_set1_pd(2),
+                  four      = _mm512_set1_pd(4),
+                  inf_roots = _mm512_set1_pd(INF_ROOTS);
+
+#define SELECT(mask, if_true, if_false) _mm512_mask_blend_pd((mask), (if_false), (if_true))
+#define IS_ALMOST_ZERO(x) _mm512_cmp_pd_mask(_mm512_abs_pd(x), eps, _CMP_LT_OQ)
+
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m512d va = _mm512_loadu_pd(a + i),
+                vb = _mm512_loadu_pd(b + i),
+                vc = _mm512_loadu_pd(c + i);
+
+        __m512d d = _mm512_sub_pd(_mm512_mul_pd(vb, vb), _mm512_mul_pd(_mm512_mul_pd(four, va), vc));
+
+        __m512d linear_n_roots    = SELECT(IS_ALMOST_ZERO(vb), SELECT(IS_ALMOST_ZERO(vc), inf_roots, zero), one),
+                quadratic_n_roots = SELECT(IS_ALMOST_ZERO(d), one,
+                                           SELECT(_mm512_cmp_pd_mask(d, zero, _CMP_GT_OQ), two, zero));
+
+        _mm256_storeu_si256((__m256i *) (n_roots + i),
+                            _mm512_maskz_cvttpd_epi32(all_lanes,
+                                                      SELECT(IS_ALMOST_ZERO(va), linear_n_roots, quadratic_n_roots)));
+    }
+
+#undef IS_ALMOST_ZERO
+#undef SELECT
+
+    classify_square_batch_scalar(a + i, b + i, c + i, n - i, n_roots + i);
+}
+
+/*
+ * The single precision kernels are the same as the double precision ones, but process twice as many lanes
+ */
+
+/*!
+ * SSE2 solve_square_batch_f kernel, processes 4 equations at a time
+ */
+__attribute__((target("sse2")))
+void solve_square_batch_f_sse2(const float *a, const float *b, const float *c, size_t n,
+                               int *n_roots, float *root1, float *root2)
+{
+    const __m128 sign_mask = _mm_set1_ps(-0.0f),
+                 eps       = _mm_set1_ps(EPS_F),
+                 zero      = _mm_setzero_ps(),
+                 one       = _mm_set1_ps(1),
+                 two       = _mm_set1_ps(2),
+                 four      = _mm_set1_ps(4),
+                 inf_roots = _mm_set1_ps(INF_ROOTS);
+
+#define SELECT(mask, if_true, if_false) _mm_or_ps(_mm_and_ps((mask), (if_true)), _mm_andnot_ps((mask), (if_false)))
+#define IS_ALMOST_ZERO(x) _mm_cmplt_ps(_mm_andnot_ps(sign_mask, (x)), eps)
+
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m128 va = _mm_loadu_ps(a + i),
+               vb = _mm_loadu_ps(b + i),
+               vc = _mm_loadu_ps(c + i);
+
+        __m128 is_linear = IS_ALMOST_ZERO(va),
+               b_is_zero = IS_ALMOST_ZERO(vb),
+               c_is_zero = IS_ALMOST_ZERO(vc);
+
+        __m128 linear_root    = _mm_div_ps(_mm_xor_ps(vc, sign_mask), vb),
+               linear_n_roots = SELECT(b_is_zero, SELECT(c_is_zero, inf_roots, zero), one);
+
+        linear_root = SELECT(b_is_zero, zero, linear_root);
+
+        __m128 two_a  = _mm_mul_ps(two, va),
+               d      = _mm_sub_ps(_mm_mul_ps(vb, vb), _mm_mul_ps(_mm_mul_ps(four, va), vc)),
+               vertex = _mm_div_ps(_mm_xor_ps(vb, sign_mask), two_a),
+               offset = _mm_div_ps(_mm_sqrt_ps(d), two_a);
+
+        __m128 d_is_zero   = IS_ALMOST_ZERO(d),
+               d_is_positive = _mm_andnot_ps(d_is_zero, _mm_cmpgt_ps(d, zero));
+
+        __m128 quadratic_n_roots = SELECT(d_is_zero, one, SELECT(d_is_positive, two, zero)),
+               quadratic_root1   = SELECT(d_is_zero, vertex,
+                                          SELECT(d_is_positive, _mm_add_ps(vertex, offset), zero)),
+               quadratic_root2   = SELECT(d_is_zero, vertex,
+                                          SELECT(d_is_positive, _mm_sub_ps(vertex, offset), zero));
+
+        _mm_storeu_si128((__m128i *) (n_roots + i),
+                         _mm_cvttps_epi32(SELECT(is_linear, linear_n_roots, quadratic_n_roots)));
+
+        _mm_storeu_ps(root1 + i, SELECT(is_linear, linear_root, quadratic_root1));
+        _mm_storeu_ps(root2 + i, SELECT(is_linear, linear_root, quadratic_root2));
+    }
+
+#undef IS_ALMOST_ZERO
+#undef SELECT
+
+    solve_square_batch_f_scalar(a + i, b + i, c + i, n - i, n_roots + i, root1 + i, root2 + i);
+}
+
+/*!
+ * AVX2 solve_square_batch_f kernel, processes 8 equations at a time
+ */
+__attribute__((target("avx2")))
+void solve_square_batch_f_avx2(const float *a, const float *b, const float *c, size_t n,
+                               int *n_roots, float *root1, float *root2)
+{
+    const __m256 sign_mask = _mm256_set1_ps(-0.0f),
+                 eps       = _mm256_set1_ps(EPS_F),
+                 zero      = _mm256_setzero_ps(),
+                 one       = _mm256_set1_ps(1),
+                 two       = _mm256_set1_ps(2),
+                 four      = _mm256_set1_ps(4),
+                 inf_roots = _mm256_set1_ps(INF_ROOTS);
+
+#define SELECT(mask, if_true, if_false) _mm256_blendv_ps((if_false), (if_true), (mask))
+#define IS_ALMOST_ZERO(x) _mm256_cmp_ps(_mm256_andnot_ps(sign_mask, (x)), eps, _CMP_LT_OQ)
+
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m256 va = _mm256_loadu_ps(a + i),
+               vb = _mm256_loadu_ps(b + i),
+               vc = _mm256_loadu_ps(c + i);
+
+        __m256 is_linear = IS_ALMOST_ZERO(va),
+               b_is_zero = IS_ALMOST_ZERO(vb),
+               c_is_zero = IS_ALMOST_ZERO(vc);
+
+        __m256 linear_root    = _mm256_div_ps(_mm256_xor_ps(vc, sign_mask), vb),
+               linear_n_roots = SELECT(b_is_zero, SELECT(c_is_zero, inf_roots, zero), one);
+
+        linear_root = SELECT(b_is_zero, zero, linear_root);
+
+        __m256 two_a  = _mm256_mul_ps(two, va),
+               d      = _mm256_sub_ps(_mm256_mul_ps(vb, vb), _mm256_mul_ps(_mm256_mul_ps(four, va), vc)),
+               vertex = _mm256_div_ps(_mm256_xor_ps(vb, sign_mask), two_a),
+               offset = _mm256_div_ps(_mm256_sqrt_ps(d), two_a);
+
+        __m256 d_is_zero     = IS_ALMOST_ZERO(d),
+               d_is_positive = _mm256_andnot_ps(d_is_zero, _mm256_cmp_ps(d, zero, _CMP_GT_OQ));
+
+        __m256 quadratic_n_roots = SELECT(d_is_zero, one, SELECT(d_is_positive, two, zero)),
+               quadratic_root1   = SELECT(d_is_zero, vertex,
+                                          SELECT(d_is_positive, _mm256_add_ps(vertex, offset), zero)),
+               quadratic_root2   = SELECT(d_is_zero, vertex,
+                                          SELECT(d_is_positive, _mm256_sub_ps(vertex, offset), zero));
+
+        _mm256_storeu_si256((__m256i *) (n_roots + i),
+                            _mm256_cvttps_epi32(SELECT(is_linear, linear_n_roots, quadratic_n_roots)));
+
+        _mm256_storeu_ps(root1 + i, SELECT(is_linear, linear_root, quadratic_root1));
+        _mm256_storeu_ps(root2 + i, SELECT(is_linear, linear_root, quadratic_root2));
+    }
+
+#undef IS_ALMOST_ZERO
+#undef SELECT
+
+    solve_square_batch_f_scalar(a + i, b + i, c + i, n - i, n_roots + i, root1 + i, root2 + i);
+}
+
+/*!
+ * AVX-512 solve_square_batch_f kernel, processes 16 equations at a time
+ */
+__attribute__((target("avx512f")))
+void solve_square_batch_f_avx512(const float *a, const float *b, const float *c, size_t n,
+                                 int *n_roots, float *root1, float *root2)
+{
+    const __m512i sign_mask = _mm512_set1_epi32((int) 0x80000000U);
+
+    /* See solve_square_batch_avx512 for the zero-masked forms */
+    const __mmask16 all_lanes = 0xFFFF;
+
+    const __m512 eps       = _mm512_set1_ps(EPS_F),
+                 zero      = _mm512_setzero_ps(),
+                 one       = _mm512_set1_ps(1),
+                 two       = _mm512_set1_ps(2),
+                 four      = _mm512_set1_ps(4),
+                 inf_roots = _mm512_set1_ps(INF_ROOTS);
+
+#define SELECT(mask, if_true, if_false) _mm512_mask_blend_ps((mask), (if_false), (if_true))
+#define IS_ALMOST_ZERO(x) _mm512_cmp_ps_mask(_mm512_abs_ps(x), eps, _CMP_LT_OQ)
+#define NEGATE(x) _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(x), sign_mask))
+
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m512 va = _mm512_loadu_ps(a + i),
+               vb = _mm512_loadu_ps(b + i),
+               vc = _mm512_loadu_ps(c + i);
+
+        __mmask16 is_linear = IS_ALMOST_ZERO(va),
+                  b_is_zero = IS_ALMOST_ZERO(vb),
+                  c_is_zero = IS_ALMOST_ZERO(vc);
+
+        __m512 linear_root    = _mm512_div_ps(NEGATE(vc), vb),
+               linear_n_roots = SELECT(b_is_zero, SELECT(c_is_zero, inf_roots, zero), one);
+
+        linear_root = SELECT(b_is_zero, zero, linear_root);
+
+        __m512 two_a  = _mm512_mul_ps(two, va),
+               d      = _mm512_sub_ps(_mm512_mul_ps(vb, vb), _mm512_mul_ps(_mm512_mul_ps(four, va), vc)),
+               vertex = _mm512_div_ps(NEGATE(vb), two_a),
+               offset = _mm512_div_ps(_mm512_maskz_sqrt_ps(all_lanes, d), two_a);
+
+        __mmask16 d_is_zero     = IS_ALMOST_ZERO(d),
+                  d_is_positive = (__mmask16) (~d_is_zero & _mm512_cmp_ps_mask(d, zero, _CMP_GT_OQ));
+
+        __m512 quadratic_n_roots = SELECT(d_is_zero, one, SELECT(d_is_positive, two, zero)),
+               quadratic_root1   = SELECT(d_is_zero, vertex,
+                                          SELECT(d_is_positive, _mm512_add_ps(vertex, offset), zero)),
+               quadratic_root2   = SELECT(d_is_zero, vertex,
+                                          SELECT(d_is_positive, _mm512_sub_ps(vertex, offset), zero));
+
+        _mm512_storeu_si512((__m512i *) (n_roots + i),
+                            _mm512_maskz_cvttps_epi32(all_lanes, SELECT(is_linear, linear_n_roots, quadratic_n_roots)));
+
+        _mm512_storeu_ps(root1 + i, SELECT(is_linear, linear_root, quadratic_root1));
+        _mm512_storeu_ps(root2 + i, SELECT(is_linear, linear_root, quadratic_root2));
+    }
+
+#undef NEGATE
+#undef IS_ALMOST_ZERO
+#undef SELECT
+
+    solve_square_batch_f_scalar(a + i, b + i, c + i, n - i, n_roots + i, root1 + i, root2 + i);
+}
+
+#endif
+
+/*!
+ * Solves square equations from the input file and writes their solutions to the output file.
+ *
+ * Each non-empty line of the input file must contain the a, b, c coefficients separated by whitespace, commas or
+ * semicolons. The file is split into chunks on line boundaries, which are parsed in parallel without locale
+ * dependent stdio. The equations are solved by solve_square_batch_parallel, and each solution is written as a line
+ * with the number of roots ("inf" for INF_ROOTS) followed by the roots
+ *
+ * @param input_file_name [in] name of the input file
+ * @param output_file_name [in] name of the output file or NULL for writing to stdout
+ *
+ * @return 0 in case of success, a non-zero value otherwise
+ */
+int solve_square_file(const char *input_file_name, const char *output_file_name)
+{
+    assert(input_file_name != NULL);
+
+    size_t input_size = 0;
+    char *input = read_file(input_file_name, &input_size);
+
+    if (input == NULL) {
+        fprintf(stderr, "ERROR: failed to read input file \"%s\"\n", input_file_name);
+        return -1;
+    }
+
+    size_t n_chunks = input_size / MIN_PARSE_CHUNK_SIZE + 1,
+           n_cpus   = std::thread::hardware_concurrency();
+
+    if ((n_cpus > 0) && (n_chunks > n_cpus)) {
+        n_chunks = n_cpus;
+    }
+
+    std::vector<parse_chunk_t> chunks(n_chunks);
+
+    size_t capacity = 0;
+
+    for (size_t i = 0; i < n_chunks; ++i) {
+        chunks[i].begin = (i == 0) ? input : chunks[i - 1].end;
+        chunks[i].end   = (i == n_chunks - 1) ? input + input_size : input + input_size / n_chunks * (i + 1);
+
+        if (chunks[i].end < chunks[i].begin) {
+            chunks[i].end = chunks[i].begin;
+        }
+
+        const char *line_end = (const char *) memchr(chunks[i].end, '\n', input + input_size - chunks[i].end);
+        chunks[i].end = (line_end != NULL) ? line_end + 1 : input + input_size;
+
+        chunks[i].offset = capacity;
+        capacity += count_lines(chunks[i].begin, chunks[i].end);
+    }
+
+    double *coefficients = (double *) calloc(3 * capacity + 1, sizeof(*coefficients));
+
+    if (coefficients == NULL) {
+        fprintf(stderr, "ERROR: failed to allocate memory for %zu equations\n", capacity);
+
+        free(input);
+        return -1;
+    }
+
+    double *a = coefficients,
+           *b = coefficients + capacity,
+           *c = coefficients + 2 * capacity;
+
+    std::vector<std::thread> threads;
+
+    for (size_t i = 1; i < n_chunks; ++i) {
+        threads.emplace_back(parse_coefficients, &chunks[i], a, b, c);
+    }
+
+    parse_coefficients(&chunks[0], a, b, c);
+
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    size_t n_equations = 0;
+
+    for (size_t i = 0; i < n_chunks; ++i) {
+        if (chunks[i].error_line != NULL) {
+            fprintf(stderr, "ERROR: invalid input at line %zu, expected 3 finite coefficients\n",
+                    count_lines(input, chunks[i].error_line));
+
+            free(coefficients);
+            free(input);
+            return -1;
+        }
+
+        memmove(a + n_equations, a + chunks[i].offset, chunks[i].n_equations * sizeof(*a));
+        memmove(b + n_equations, b + chunks[i].offset, chunks[i].n_equations * sizeof(*b));
+        memmove(c + n_equations, c + chunks[i].offset, chunks[i].n_equations * sizeof(*c));
+
+        n_equations += chunks[i].n_equations;
+    }
+
+    free(input);
+
+    FILE *output = (output_file_name != NULL) ? fopen(output_file_name, "wb") : stdout;
+
+    if (output == NULL) {
+        fprintf(stderr, "ERROR: failed to open output file \"%s\"\n", output_file_name);
+
+        free(coefficients);
+        return -1;
+    }
+
+    int *n_roots = (int *) calloc(n_equations + 1, sizeof(*n_roots));
+    double *roots = (double *) calloc(2 * n_equations + 1, sizeof(*roots));
+    char *formatted = (char *) calloc(SOLVE_BATCH_SIZE * MAX_SOLUTION_LEN, sizeof(*formatted));
+
+    int error_flag = ((n_roots == NULL) || (roots == NULL) || (formatted == NULL)) ? -1 : 0;
+
+    if (error_flag) {
+        fprintf(stderr, "ERROR: failed to allocate memory for solutions\n");
+    } else {
+        solve_square_batch_parallel(a, b, c, n_equations, n_roots, roots, roots + n_equations, 0, NULL);
+    }
+
+    for (size_t begin = 0; (begin < n_equations) && !error_flag; begin += SOLVE_BATCH_SIZE) {
+        size_t batch_end = (n_equations - begin < SOLVE_BATCH_SIZE) ? n_equations : begin + SOLVE_BATCH_SIZE;
+
+        char *writer = formatted;
+
+        for (size_t i = begin; i < batch_end; ++i) {
+            writer = format_solution(writer, n_roots[i], roots[i], roots[n_equations + i]);
+        }
+
+        if (fwrite(formatted, sizeof(*formatted), writer - formatted, output) != (size_t) (writer - formatted)) {
+            fprintf(stderr, "ERROR: failed to write solutions\n");
+
+            error_flag = -1;
+        }
+    }
+
+    free(formatted);
+    free(roots);
+    free(n_roots);
+    free(coefficients);
+
+    if ((output != stdout) ? fclose(output) : fflush(output)) {
+        fprintf(stderr, "ERROR: failed to write solutions\n");
+
+        error_flag = -1;
+    }
+
+    return error_flag;
+}
+
+/*!
+ * Reads a whole file to a buffer, which must be freed by caller
+ *
+ * @param file_name [in] name of the file
+ * @param size [out] pointer to the file size
+ *
+ * @return pointer to the buffer
+ *
+ * @note Returns NULL in case of failure
+ */
+char *read_file(const char *file_name, size_t *size)
+{
+    assert(file_name != NULL);
+    assert(size != NULL);
+
+    FILE *file = fopen(file_name, "rb");
+
+    if (file == NULL) {
+        return NULL;
+    }
+
+#ifdef _WIN32
+    long long file_size = _fseeki64(file, 0, SEEK_END) ? -1 : _ftelli64(file);
+#else
+    struct stat file_stat = {};
+    long long file_size = fstat(fileno(file), &file_stat) ? -1 : (long long) file_stat.st_size;
+#endif
+
+    if ((file_size < 0) || ((unsigned long long) file_size >= SIZE_MAX) || fseek(file, 0, SEEK_SET)) {
+        fclose(file);
+        return NULL;
+    }
+
+    *size = (size_t) file_size;
+
+    char *buffer = (char *) calloc(*size + 1, sizeof(*buffer));
+
+    if ((buffer != NULL) && (fread(buffer, sizeof(*buffer), *size, file) != *size)) {
+        free(buffer);
+        buffer = NULL;
+    }
+
+    fclose(file);
+
+    return buffer;
+}
+
+/*!
+ * Counts lines in range [begin, end), including the last line without the line feed
+ *
+ * @param begin [in] the range beginning
+ * @param end [in] the range end
+ *
+ * @return the number of lines
+ */
+size_t count_lines(const char *begin, const char *end)
+{
+    assert(begin != NULL);
+    assert(end != NULL);
+
+    size_t n_lines = 0;
+
+    while ((begin < end) && ((begin = (const char *) memchr(begin, '\n', end - begin)) != NULL)) {
+        ++n_lines;
+        ++begin;
+    }
+
+    return n_lines + 1;
+}
+
+/*!
+ * Parses coefficients of equations from an input file chunk, skipping empty lines. A coefficient may have a
+ * leading '+', which std::from_chars doesn't accept, so it's skipped. Each coefficient must be followed by one of
+ * COEFFICIENT_SEPARATORS or the end of line, so that lines like "1-2 3" are rejected
+ *
+ * @param chunk [in, out] pointer to the chunk, its n_equations and error_line are set
+ * @param a [out] array of quadratic coefficients, written starting from the chunk offset
+ * @param b [out] array of linear coefficients, written starting from the chunk offset
+ * @param c [out] array of free terms, written starting from the chunk offset
+ *
+ * @note error_line is set to the beginning of the first invalid line or NULL
+ */
+void parse_coefficients(parse_chunk_t *chunk, double *a, double *b, double *c)
+{
+    assert(chunk != NULL);
+    assert(a != NULL);
+    assert(b != NULL);
+    assert(c != NULL);
+
+    chunk->n_equations = 0;
+    chunk->error_line  = NULL;
+
+    double *coefficients[] = {a + chunk->offset, b + chunk->offset, c + chunk->offset};
+
+    for (const char *line = chunk->begin; line < chunk->end;) {
+        const char *line_end = (const char *) memchr(line, '\n', chunk->end - line);
+
+        if (line_end == NULL) {
+            line_end = chunk->end;
+        }
+
+        size_t n_coefficients = 0;
+
+        for (const char *reader = line;;) {
+            while ((reader < line_end) && strchr(COEFFICIENT_SEPARATORS, *reader)) {
+                ++reader;
+            }
+
+            if (reader == line_end) {
+                break;
+            }
+
+            if ((*reader == '+') && (reader + 1 < line_end) && (reader[1] != '-')) {
+                ++reader;
+            }
+
+            double value = 0;
+            std::from_chars_result result = std::from_chars(reader, line_end, value);
+
+            int is_separated = (result.ptr == line_end) ||
+                               ((*result.ptr != '\0') && (strchr(COEFFICIENT_SEPARATORS, *result.ptr) != NULL));
+
+            if ((result.ec != std::errc()) || !is_separated || (n_coefficients == 3) || !isfinite(value)) {
+                chunk->error_line = line;
+                return;
+            }
+
+            coefficients[n_coefficients++][chunk->n_equations] = value;
+            reader = result.ptr;
+        }
+
+        if (n_coefficients == 3) {
+            ++chunk->n_equations;
+        } else if (n_coefficients != 0) {
+            chunk->error_line = line;
+            return;
+        }
+
+        line = line_end + 1;
+    }
+}
+
+/*!
+ * Formats a solution of a square equation as a line
+ *
+ * @param writer [out] pointer to a buffer of at least MAX_SOLUTION_LEN chars
+ * @param n_roots [in] the number of roots
+ * @param root1 [in] the greater root
+ * @param root2 [in] the lesser root
+ *
+ * @return pointer to the end of the formatted line
+ */
+char *format_solution(char *writer, int n_roots, double root1, double root2)
+{
+    assert(writer != NULL);
+
+    char *end = writer + MAX_SOLUTION_LEN;
+
+    if (n_roots == INF_ROOTS) {
+        memcpy(writer, "inf", 3);
+        writer += 3;
+    } else {
+        *(writer++) = (char) ('0' + n_roots);
+    }
+
+    if (n_roots >= 1) {
+        *(writer++) = ' ';
+        writer = std::to_chars(writer, end, root1).ptr;
+    }
+
+    if (n_roots == 2) {
+        *(writer++) = ' ';
+        writer = std::to_chars(writer, end, root2).ptr;
+    }
+
+    *(writer++) = '\n';
+
+    return writer;
+}
+
+/*!
+ * Solves square equations from a binary coefficient file and writes their solutions to a binary solution file.
+ * Both files are mapped to memory, so the equations are solved in place without parsing and formatting
+ *
+ * @param input_file_name [in] name of the binary coefficient file
+ * @param output_file_name [in] name of the binary solution file, which is created or overwritten
+ *
+ * @return 0 in case of success, a non-zero value otherwise
+ *
+ * @note The binary files format is described at binary_header_t
+ */
+int solve_square_mapped(const char *input_file_name, const char *output_file_name)
+{
+    assert(input_file_name != NULL);
+    assert(output_file_name != NULL);
+
+    mapped_file_t input = {};
+
+    if (map_file(input_file_name, 0, 0, &input)) {
+        fprintf(stderr, "ERROR: failed to map input file \"%s\"\n", input_file_name);
+        return -1;
+    }
+
+    const binary_header_t *input_header = (const binary_header_t *) input.data;
+
+    if ((input.size < sizeof(*input_header)) ||
+        (memcmp(input_header->magic, BINARY_INPUT_MAGIC, sizeof(BINARY_INPUT_MAGIC)) != 0) ||
+        (input_header->version != BINARY_VERSION) || (input_header->header_size < sizeof(*input_header)) ||
+        (input_header->header_size % BINARY_COLUMN_ALIGNMENT != 0)) {
+        fprintf(stderr, "ERROR: \"%s\" is not a binary coefficient file of version %u\n",
+                input_file_name, (unsigned) BINARY_VERSION);
+
+        unmap_file(&input);
+        return -1;
+    }
+
+    size_t n_equations = (size_t) input_header->n_equations,
+           column_size = get_binary_column_size(n_equations, sizeof(double));
+
+    if ((n_equations > SIZE_MAX / sizeof(double) / 3) || (input.size < input_header->header_size + 3 * column_size)) {
+        fprintf(stderr, "ERROR: binary coefficient file \"%s\" is truncated\n", input_file_name);
+
+        unmap_file(&input);
+        return -1;
+    }
+
+    const char *input_columns = (const char *) input.data + input_header->header_size;
+
+    const double *a = (const double *) input_columns,
+                 *b = (const double *) (input_columns + column_size),
+                 *c = (const double *) (input_columns + 2 * column_size);
+
+    size_t invalid_i = find_non_finite_coefficients(a, b, c, n_equations);
+
+    if (invalid_i != n_equations) {
+        fprintf(stderr, "ERROR: invalid input at equation %zu, expected 3 finite coefficients\n", invalid_i + 1);
+
+        unmap_file(&input);
+        return -1;
+    }
+
+    size_t n_roots_column_size = get_binary_column_size(n_equations, sizeof(int32_t));
+
+    mapped_file_t output = {};
+
+    if (map_file(output_file_name, sizeof(binary_header_t) + n_roots_column_size + 2 * column_size, 1, &output)) {
+        fprintf(stderr, "ERROR: failed to map output file \"%s\"\n", output_file_name);
+
+        unmap_file(&input);
+        return -1;
+    }
+
+    binary_header_t *output_header = (binary_header_t *) output.data;
+
+    memcpy(output_header->magic, BINARY_OUTPUT_MAGIC, sizeof(BINARY_OUTPUT_MAGIC));
+    output_header->version     = BINARY_VERSION;
+    output_header->header_size = sizeof(*output_header);
+    output_header->n_equations = n_equations;
+
+    char *output_columns = (char *) output.data + sizeof(*output_header);
+
+    root_count_stats_t stats = {};
+
+    solve_square_batch_parallel(a, b, c, n_equations, (int *) output_columns,
+                                (double *) (output_columns + n_roots_column_size),
+                                (double *) (output_columns + n_roots_column_size + column_size), 0, &stats);
+
+    printf("Solved %zu equations: %zu without roots, %zu with 1 root, %zu with 2 roots, %zu with an infinite number "
+           "of roots\n", n_equations, stats.n_no_roots, stats.n_one_root, stats.n_two_roots, stats.n_inf_roots);
+
+    int error_flag = 0;
+
+    if (unmap_file(&output)) {
+        fprintf(stderr, "ERROR: failed to write output file \"%s\"\n", output_file_name);
+
+        error_flag = -1;
+    }
+
+    unmap_file(&input);
+
+    return error_flag;
+}
+
+/*!
+ * Computes the size of a binary file column, padded up to BINARY_COLUMN_ALIGNMENT
+ *
+ * @param n_elements [in] the number of elements
+ * @param element_size [in] the size of an element
+ *
+ * @return the column size in bytes
+ */
+size_t get_binary_column_size(size_t n_elements, size_t element_size)
+{
+    size_t n_blocks = (n_elements * element_size + BINARY_COLUMN_ALIGNMENT - 1) / BINARY_COLUMN_ALIGNMENT;
+
+    return n_blocks * BINARY_COLUMN_ALIGNMENT;
+}
+
+/*!
+ * Finds the first equation with a coefficient, which is infinite or NaN
+ *
+ * @param a [in] array of quadratic coefficients
+ * @param b [in] array of linear coefficients
+ * @param c [in] array of free terms
+ * @param n [in] the number of equations
+ *
+ * @return index of the equation or n if all coefficients are finite
+ *
+ * @note Blocks of equations are checked without branches, so that the check is vectorized
+ */
+size_t find_non_finite_coefficients(const double *a, const double *b, const double *c, size_t n)
+{
+    const size_t BLOCK_SIZE = 256;
+
+    for (size_t begin = 0; begin < n; begin += BLOCK_SIZE) {
+        size_t end = (n - begin < BLOCK_SIZE) ? n : begin + BLOCK_SIZE;
+
+        int are_finite = 1;
+
+        for (size_t i = begin; i < end; ++i) {
+            are_finite &= isfinite(a[i]) & isfinite(b[i]) & isfinite(c[i]);
+        }
+
+        if (!are_finite) {
+            for (size_t i = begin; i < end; ++i) {
+                if (!isfinite(a[i]) || !isfinite(b[i]) || !isfinite(c[i])) {
+                    return i;
+                }
+            }
+        }
+    }
+
+    return n;
+}
+
+/*!
+ * Maps a file to memory
+ *
+ * @param file_name [in] name of the file
+ * @param size [in] the size of the file, which is created or overwritten, if writable, otherwise ignored
+ * @param writable [in] non-zero value for mapping the file for writing, otherwise the file is mapped for reading
+ * @param mapped [out] pointer to the mapped file
+ *
+ * @return 0 in case of success, a non-zero value otherwise
+ *
+ * @note The blocks of a file mapped for writing are allocated in advance, so that running out of disk space is
+ * reported here instead of raising a signal on writing to the mapping
+ */
+int map_file(const char *file_name, size_t size, int writable, mapped_file_t *mapped)
+{
+    assert(file_name != NULL);
+    assert(mapped != NULL);
+    assert(!writable || (size > 0));
+
+    mapped->writable = writable;
+
+#ifdef _WIN32
+    mapped->file = CreateFileA(file_name, writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+                               writable ? 0 : FILE_SHARE_READ, NULL, writable ? CREATE_ALWAYS : OPEN_EXISTING,
+                               FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+    if (mapped->file == INVALID_HANDLE_VALUE) {
+        return -1;
+    }
+
+    if (!writable) {
+        LARGE_INTEGER file_size = {};
+
+        if (!GetFileSizeEx(mapped->file, &file_size)) {
+            CloseHandle(mapped->file);
+            return -1;
+        }
+
+        size = (size_t) file_size.QuadPart;
+    } else {
+        FILE_ALLOCATION_INFO allocation_info = {};
+        allocation_info.AllocationSize.QuadPart = (LONGLONG) size;
+
+        if (!SetFileInformationByHandle(mapped->file, FileAllocationInfo, &allocation_info, sizeof(allocation_info))) {
+            CloseHandle(mapped->file);
+            return -1;
+        }
+    }
+
+    mapped->size = size;
+
+    mapped->mapping = CreateFileMappingA(mapped->file, NULL, writable ? PAGE_READWRITE : PAGE_READONLY,
+                                         (DWORD) ((uint64_t) size >> 32), (DWORD) size, NULL);
+
+    if (mapped->mapping == NULL) {
+        CloseHandle(mapped->file);
+        return -1;
+    }
+
+    mapped->data = MapViewOfFile(mapped->mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size);
+
+    if (mapped->data == NULL) {
+        CloseHandle(mapped->mapping);
+        CloseHandle(mapped->file);
+        return -1;
+    }
+#else
+    mapped->fd = writable ? open(file_name, O_RDWR | O_CREAT | O_TRUNC, 0644) : open(file_name, O_RDONLY);
+
+    if (mapped->fd < 0) {
+        return -1;
+    }
+
+    struct stat file_stat = {};
+
+    if (writable ? (posix_fallocate(mapped->fd, 0, (off_t) size) != 0) : (fstat(mapped->fd, &file_stat) != 0)) {
+        close(mapped->fd);
+        return -1;
+    }
+
+    mapped->size = writable ? size : (size_t) file_stat.st_size;
+
+    mapped->data = mmap(NULL, mapped->size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, mapped->fd, 0);
+
+    if (mapped->data == MAP_FAILED) {
+        close(mapped->fd);
+        return -1;
+    }
+
+    madvise(mapped->data, mapped->size, MADV_SEQUENTIAL);
+#endif
+
+    return 0;
+}
+
+/*!
+ * Unmaps a file from memory, flushing the changes to the disk, if it was mapped for writing
+ *
+ * @param mapped [in, out] pointer to the mapped file
+ *
+ * @return 0 in case of success, a non-zero value otherwise
+ */
+int unmap_file(mapped_file_t *mapped)
+{
+    assert(mapped != NULL);
+
+#ifdef _WIN32
+    int error_flag = mapped->writable && !FlushViewOfFile(mapped->data, 0);
+    error_flag |= !UnmapViewOfFile(mapped->data);
+    error_flag |= !CloseHandle(mapped->mapping);
+    error_flag |= mapped->writable && !FlushFileBuffers(mapped->file);
+    error_flag |= !CloseHandle(mapped->file);
+#else
+    int error_flag = mapped->writable && msync(mapped->data, mapped->size, MS_SYNC);
+    error_flag |= munmap(mapped->data, mapped->size);
+    error_flag |= close(mapped->fd);
+#endif
+
+    mapped->data = NULL;
+
+    return error_flag ? -1 : 0;
+}
+
+/*!
+ * Measures the accuracy of solve_square and solve_square_stable in ulp against a reference solution in double-double
+ * precision, as well as their throughput, over random equations, and prints the results
+ *
+ * @param n_equations [in] the number of random equations
+ *
+ * @return 0 in case of success, otherwise -1
+ *
+ * @note Half of the equations have b^2 much greater than |4ac|, so that the roots are prone to cancellation
+ */
+int measure_solve_square_ulp(size_t n_equations)
+{
+    assert(n_equations > 0);
+
+    std::vector<double> a(n_equations), b(n_equations), c(n_equations);
+
+    srand(7);
+
+    for (size_t i = 0; i < n_equations; ++i) {
+        a[i] = get_random_coefficient(-4, 4);
+        c[i] = get_random_coefficient(-4, 4);
+
+        if (i % 2) {
+            b[i] = copysign(sqrt(fabs(4 * a[i] * c[i])), (rand() % 2) ? 1.0 : -1.0) * pow(10, 6.0 * rand() / RAND_MAX);
+        } else {
+            b[i] = get_random_coefficient(-4, 4);
+        }
+    }
+
+    struct {
+        const char *name;
+        int (*solver)(double a, double b, double c, double *root1, double *root2);
+    } solvers[] = {
+        {"solve_square",        solve_square},
+        {"solve_square_stable", solve_square_stable},
+    };
+
+    std::vector<double> root1(n_equations), root2(n_equations);
+    std::vector<int> n_roots(n_equations);
+
+    for (size_t solver_i = 0; solver_i < sizeof(solvers) / sizeof(solvers[0]); ++solver_i) {
+        auto start = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < n_equations; ++i) {
+            n_roots[i] = (*solvers[solver_i].solver)(a[i], b[i], c[i], &root1[i], &root2[i]);
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double max_ulp_error = 0, total_ulp_error = 0;
+        size_t n_measured_roots = 0, n_mismatches = 0;
+
+        for (size_t i = 0; i < n_equations; ++i) {
+            double_double_t reference_root1 = {}, reference_root2 = {};
+            int reference_n_roots = solve_square_reference(a[i], b[i], c[i], &reference_root1, &reference_root2);
+
+            if (n_roots[i] != reference_n_roots) {
+                ++n_mismatches;
+                continue;
+            }
+
+            if (n_roots[i] != 2) {
+                continue;
+            }
+
+            double ulp_errors[2] = {get_ulp_error(root1[i], reference_root1), get_ulp_error(root2[i], reference_root2)};
+
+            for (int k = 0; k < 2; ++k) {
+                max_ulp_error = fmax(max_ulp_error, ulp_errors[k]);
+                total_ulp_error += ulp_errors[k];
+                ++n_measured_roots;
+            }
+        }
+
+        printf("%s: max error %.3g ulp, mean error %.3g ulp over %zu roots, %zu root count mismatches, "
+               "%.3g ns/equation, %.3g equations/s\n",
+               solvers[solver_i].name, max_ulp_error,
+               (n_measured_roots != 0) ? total_ulp_error / (double) n_measured_roots : 0.0, n_measured_roots,
+               n_mismatches, seconds * 1e9 / (double) n_equations, (double) n_equations / seconds);
+    }
+
+    return 0;
+}
+
+/*!
+ * Solves square equation ax^2 + bx + c = 0 in double-double precision, as a reference for measuring the accuracy of
+ * the solvers. The number of roots is decided by the same tolerance as in solve_square, but from the exact
+ * discriminant, so that the root count errors of the solvers are counted too
+ *
+ * @param a [in] quadratic coefficient
+ * @param b [in] linear coefficient
+ * @param c [in] free term
+ * @param root1 [out] pointer to the root (-b + sqrt(d)) / 2a, like of solve_square
+ * @param root2 [out] pointer to the root (-b - sqrt(d)) / 2a, like of solve_square
+ *
+ * @return the number of roots
+ *
+ * @note Returns INF_ROOTS in case of an infinite number of roots. The roots are only set for 2 roots
+ */
+int solve_square_reference(double a, double b, double c, double_double_t *root1, double_double_t *root2)
+{
+    assert(isfinite(a));
+    assert(isfinite(b));
+    assert(isfinite(c));
+
+    assert(root1 != NULL);
+    assert(root2 != NULL);
+
+    if (are_almost_equal(a, 0)) {
+        if (are_almost_equal(b, 0)) {
+            return are_almost_equal(c, 0) ? INF_ROOTS : 0;
+        }
+
+        return 1;
+    }
+
+    /* b^2 and 4ac are exact in double-double, so that d only has the rounding error of the subtraction */
+    double_double_t b_dd = make_double_double(b, 0),
+                    d    = add_double_double(multiply_double_double(b_dd, b_dd),
+                                             multiply_double_double(make_double_double(-4 * a, 0),
+                                                                    make_double_double(c, 0)));
+
+    if (are_almost_equal(d.hi, 0)) {
+        return 1;
+    } else if (d.hi < 0) {
+        return 0;
+    }
+
+    double_double_t sqrt_d = sqrt_double_double(d);
+
+    if (b < 0) {
+        sqrt_d = make_double_double(-sqrt_d.hi, -sqrt_d.lo);
+    }
+
+    /* q = -(b + sign(b) sqrt(d)) / 2 doesn't suffer from cancellation, and the roots are q/a and c/q */
+    double_double_t q = multiply_double_double(make_double_double(-0.5, 0), add_double_double(b_dd, sqrt_d));
+
+    double_double_t x1 = divide_double_double(q, make_double_double(a, 0)),
+                    x2 = divide_double_double(make_double_double(c, 0), q);
+
+    *root1 = (b < 0) ? x1 : x2;
+    *root2 = (b < 0) ? x2 : x1;
+
+    return 2;
+}
+
+/*!
+ * Computes the error of a root in ulp of the reference root rounded to double precision
+ *
+ * @param root [in] the root
+ * @param reference_root [in] the reference root
+ *
+ * @return the error in ulp
+ */
+double get_ulp_error(double root, double_double_t reference_root)
+{
+    double rounded_reference_root = fabs(reference_root.hi);
+    double ulp = nextafter(rounded_reference_root, INFINITY) - rounded_reference_root;
+
+    double_double_t error = add_double_double(make_double_double(root, 0),
+                                              make_double_double(-reference_root.hi, -reference_root.lo));
+
+    return fabs(error.hi) / ulp;
+}
+
+/*!
+ * Adds 2 double-double numbers
+ *
+ * @param x [in] first double-double number
+ * @param y [in] second double-double number
+ *
+ * @return the sum, with relative error of about 2^-106
+ */
+double_double_t add_double_double(double_double_t x, double_double_t y)
+{
+    /* Knuth's two-sum of the high and the low parts, which doesn't depend on their magnitudes */
+    double hi_sum = x.hi + y.hi, hi_sum_b = hi_sum - x.hi,
+           hi_error = (x.hi - (hi_sum - hi_sum_b)) + (y.hi - hi_sum_b);
+
+    double lo_sum = x.lo + y.lo, lo_sum_b = lo_sum - x.lo,
+           lo_error = (x.lo - (lo_sum - lo_sum_b)) + (y.lo - lo_sum_b);
+
+    double_double_t sum = make_double_double(hi_sum, hi_error + lo_sum);
+
+    return make_double_double(sum.hi, sum.lo + lo_error);
+}
+
+/*!
+ * Multiplies 2 double-double numbers
+ *
+ * @param x [in] first double-double number
+ * @param y [in] second double-double number
+ *
+ * @return the product, with relative error of about 2^-106
+ *
+ * @note The rounding error of x.hi * y.hi is computed exactly by FMA
+ */
+double_double_t multiply_double_double(double_double_t x, double_double_t y)
+{
+    double product = x.hi * y.hi,
+           product_error = fma(x.hi, y.hi, -product);
+
+    return make_double_double(product, product_error + (x.hi * y.lo + x.lo * y.hi));
+}
+
+/*!
+ * Divides 2 double-double numbers
+ *
+ * @param x [in] the dividend
+ * @param y [in] the divisor, which must not be 0
+ *
+ * @return the quotient, with relative error of about 2^-106
+ */
+double_double_t divide_double_double(double_double_t x, double_double_t y)
+{
+    assert(y.hi != 0);
+
+    /* Long division: each quotient digit is computed in double precision from the remainder */
+    double quotient1 = x.hi / y.hi;
+
+    double_double_t remainder = add_double_double(x, multiply_double_double(make_double_double(-quotient1, 0), y));
+
+    double quotient2 = remainder.hi / y.hi;
+
+    remainder = add_double_double(remainder, multiply_double_double(make_double_double(-quotient2, 0), y));
+
+    double quotient3 = remainder.hi / y.hi;
+
+    double_double_t quotient = make_double_double(quotient1, quotient2);
+
+    return add_double_double(quotient, make_double_double(quotient3, 0));
+}
+
+/*!
+ * Computes the square root of a double-double number
+ *
+ * @param x [in] non-negative double-double number
+ *
+ * @return the square root, with relative error of about 2^-106
+ *
+ * @note The double precision square root is refined by a step of Newton's method
+ */
+double_double_t sqrt_double_double(double_double_t x)
+{
+    assert(x.hi >= 0);
+
+    if (x.hi == 0) {
+        return make_double_double(0, 0);
+    }
+
+    double root = sqrt(x.hi);
+
+    double_double_t root_dd  = make_double_double(root, 0),
+                    square   = multiply_double_double(root_dd, root_dd),
+                    residual = add_double_double(x, make_double_double(-square.hi, -square.lo));
+
+    return add_double_double(root_dd, make_double_double(residual.hi / (2 * root), 0));
+}
+
+/*!
+ * Makes a normalized double-double number from the sum of 2 doubles, |lo| <= |hi| or hi = 0
+ *
+ * @param hi [in] the high part
+ * @param lo [in] the low part
+ *
+ * @return the double-double number hi + lo
+ */
+double_double_t make_double_double(double hi, double lo)
+{
+    double sum = hi + lo;
+
+    return {sum, lo - (sum - hi)};
+}
+
+/*!
+ * Generates random coefficient with random sign and magnitude distributed log-uniformly
+ *
+ * @param min_exponent [in] decimal exponent of the minimum magnitude
+ * @param max_exponent [in] decimal exponent of the maximum magnitude
+ *
+ * @return the coefficient
+ */
+double get_random_coefficient(double min_exponent, double max_exponent)
+{
+    double magnitude = pow(10, min_exponent + (max_exponent - min_exponent) * rand() / RAND_MAX);
+
+    return (rand() % 2) ? magnitude : -magnitude;
+}
+
+/*!
+ * Parses positive count from command line argument
+ *
+ * @param str [in] the argument
+ * @param count [out] pointer to the count
+ *
+ * @return 0 in case of success, otherwise -1
+ */
+int parse_count(const char *str, size_t *count)
+{
+    assert(str != NULL);
+    assert(count != NULL);
+
+    char *end = NULL;
+    unsigned long long value = strtoull(str, &end, 10);
+
+    if ((end == str) || (*end != '\0') || (value == 0) || (value > SIZE_MAX)) {
+        return -1;
+    }
+
+    *count = (size_t) value;
+
+    return 0;
+}
+
+/*!
+ * Benchmarks the scalar, batch and classification solvers over distributions of coefficients and prints the results
+ * as JSON
+ *
+ * @param n_equations [in] the number of equations solved by each solver
+ * @param distribution_name [in] name of the distribution of coefficients or NULL for all distributions
+ *
+ * @return 0 in case of success, otherwise -1
+ *
+ * @note Branch miss rates are measured by perf_event_open on Linux, otherwise and if it's not permitted they are null
+ */
+int benchmark_solve_square(size_t n_equations, const char *distribution_name)
+{
+    assert(n_equations > 0);
+
+    struct {
+        const char *name;
+        generate_coefficients_t *generate;
+    } distributions[] = {
+        {"random",                 generate_random_coefficients},
+        {"degenerate",             generate_degenerate_coefficients},
+        {"near_zero_discriminant", generate_near_zero_discriminant_coefficients},
+        {"mixed_sign",             generate_mixed_sign_coefficients},
+    };
+
+    const size_t N_DISTRIBUTIONS = sizeof(distributions) / sizeof(distributions[0]);
+
+    size_t distribution_i = 0;
+
+    if (distribution_name != NULL) {
+        while ((distribution_i < N_DISTRIBUTIONS) &&
+               (strcmp(distributions[distribution_i].name, distribution_name) != 0)) {
+            ++distribution_i;
+        }
+
+        if (distribution_i == N_DISTRIBUTIONS) {
+            fprintf(stderr, "ERROR: unknown distribution of coefficients \"%s\"\n", distribution_name);
+            return -1;
+        }
+    }
+
+    struct {
+        const char *name;
+        solve_square_batch_kernel_t *solver;
+    } solvers[] = {
+        {"solve_square",                solve_square_batch_scalar},
+        {"solve_square_stable",         benchmark_solve_square_stable},
+        {"solve_square_batch",          solve_square_batch},
+        {"solve_square_batch_mixed",    solve_square_batch_mixed},
+        {"solve_square_batch_parallel", benchmark_solve_square_batch_parallel},
+        {"classify_square_batch",       benchmark_classify_square_batch},
+    };
+
+    const size_t N_SOLVERS = sizeof(solvers) / sizeof(solvers[0]);
+
+    std::vector<double> a(n_equations), b(n_equations), c(n_equations), root1(n_equations), root2(n_equations);
+    std::vector<int> n_roots(n_equations);
+
+    branch_counters_t counters = {};
+    int are_counters_open = (open_branch_counters(&counters) == 0);
+
+    printf("{\n"
+           "    \"n_equations\": %zu,\n"
+           "    \"n_repetitions\": %d,\n"
+           "    \"results\": [",
+           n_equations, BENCHMARK_REPETITIONS);
+
+    int is_first_result = 1;
+
+    for (; distribution_i < N_DISTRIBUTIONS; ++distribution_i) {
+        srand(8);
+        (*distributions[distribution_i].generate)(a.data(), b.data(), c.data(), n_equations);
+
+        for (size_t solver_i = 0; solver_i < N_SOLVERS; ++solver_i) {
+            /* Warm up, e.g. select the kernel and fault the output pages in */
+            (*solvers[solver_i].solver)(a.data(), b.data(), c.data(), n_equations,
+                                        n_roots.data(), root1.data(), root2.data());
+
+            double best_seconds = INFINITY;
+            uint64_t n_branches = 0, n_misses = 0;
+
+            for (int repetition = 0; repetition < BENCHMARK_REPETITIONS; ++repetition) {
+                if (are_counters_open) {
+                    enable_branch_counters(&counters, 1);
+                }
+
+                auto start = std::chrono::steady_clock::now();
+
+                (*solvers[solver_i].solver)(a.data(), b.data(), c.data(), n_equations,
+                                            n_roots.data(), root1.data(), root2.data());
+
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+                if (are_counters_open) {
+                    enable_branch_counters(&counters, 0);
+                }
+
+                best_seconds = fmin(best_seconds, seconds);
+            }
+
+            int are_counters_read = are_counters_open && (read_branch_counters(&counters, &n_branches, &n_misses) == 0);
+
+            printf("%s\n"
+                   "        {\"distribution\": \"%s\", \"solver\": \"%s\", \"ns_per_equation\": %.4g, "
+                   "\"equations_per_second\": %.4g, ",
+                   is_first_result ? "" : ",", distributions[distribution_i].name, solvers[solver_i].name,
+                   best_seconds * 1e9 / (double) n_equations, (double) n_equations / best_seconds);
+
+            if (are_counters_read && (n_branches != 0)) {
+                printf("\"branch_miss_rate\": %.4g, \"branch_misses_per_equation\": %.4g}",
+                       (double) n_misses / (double) n_branches,
+                       (double) n_misses / (double) n_equations / BENCHMARK_REPETITIONS);
+            } else {
+                printf("\"branch_miss_rate\": null, \"branch_misses_per_equation\": null}");
+            }
+
+            is_first_result = 0;
+        }
+
+        if (distribution_name != NULL) {
+            break;
+        }
+    }
+
+    printf("\n    ]\n}\n");
+
+    if (are_counters_open) {
+        close_branch_counters(&counters);
+    }
+
+    return 0;
+}
+
+/*!
+ * Generates coefficients distributed uniformly in [-10, 10]
+ *
+ * @param a [out] array of quadratic coefficients
+ * @param b [out] array of linear coefficients
+ * @param c [out] array of free terms
+ * @param n [in] the number of equations
+ */
+void generate_random_coefficients(double *a, double *b, double *c, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = 20.0 * rand() / RAND_MAX - 10;
+        b[i] = 20.0 * rand() / RAND_MAX - 10;
+        c[i] = 20.0 * rand() / RAND_MAX - 10;
+    }
+}
+
+/*!
+ * Generates coefficients like generate_random_coefficients, but with the quadratic coefficients almost equal to 0
+ * in 90% of equations and the linear ones in 10% of them
+ */
+void generate_degenerate_coefficients(double *a, double *b, double *c, size_t n)
+{
+    generate_random_coefficients(a, b, c, n);
+
+    for (size_t i = 0; i < n; ++i) {
+        if (rand() % 10 != 0) {
+            a[i] = EPS * rand() / RAND_MAX - EPS / 2;
+        }
+
+        if (rand() % 10 == 0) {
+            b[i] = EPS * rand() / RAND_MAX - EPS / 2;
+        }
+    }
+}
+
+/*!
+ * Generates coefficients like generate_random_coefficients, but with the discriminants about the tolerance, so that
+ * the number of roots is unpredictable
+ */
+void generate_near_zero_discriminant_coefficients(double *a, double *b, double *c, size_t n)
+{
+    generate_random_coefficients(a, b, c, n);
+
+    for (size_t i = 0; i < n; ++i) {
+        c[i] = copysign(c[i], a[i]);
+
+        double d = 4 * EPS * rand() / RAND_MAX - 2 * EPS;
+        b[i] = sqrt(fmax(4 * a[i] * c[i] + d, 0));
+    }
+}
+
+/*!
+ * Generates coefficients with random signs and magnitudes distributed log-uniformly in [1e-4, 1e4]
+ */
+void generate_mixed_sign_coefficients(double *a, double *b, double *c, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = get_random_coefficient(-4, 4);
+        b[i] = get_random_coefficient(-4, 4);
+        c[i] = get_random_coefficient(-4, 4);
+    }
+}
+
+/*!
+ * Solves n square equations by solve_square_stable, with the signature of solve_square_batch for the benchmark
+ */
+void benchmark_solve_square_stable(const double *a, const double *b, const double *c, size_t n,
+                                   int *n_roots, double *root1, double *root2)
+{
+    for (size_t i = 0; i < n; ++i) {
+        root1[i] = root2[i] = 0;
+
+        n_roots[i] = solve_square_stable(a[i], b[i], c[i], &root1[i], &root2[i]);
+    }
+}
+
+/*!
+ * Solves n square equations by solve_square_batch_parallel on all CPUs, with the signature of solve_square_batch for
+ * the benchmark
+ */
+void benchmark_solve_square_batch_parallel(const double *a, const double *b, const double *c, size_t n,
+                                           int *n_roots, double *root1, double *root2)
+{
+    solve_square_batch_parallel(a, b, c, n, n_roots, root1, root2, 0, NULL);
+}
+
+/*!
+ * Classifies n square equations by classify_square_batch, with the signature of solve_square_batch for the benchmark
+ */
+void benchmark_classify_square_batch(const double *a, const double *b, const double *c, size_t n,
+                                     int *n_roots, double *root1, double *root2)
+{
+    (void) root1;
+    (void) root2;
+
+    classify_square_batch(a, b, c, n, n_roots, NULL);
+}
+
+/*!
+ * Opens the hardware counters of branches and branch misses, which are disabled initially
+ *
+ * @param counters [out] pointer to the counters
+ *
+ * @return 0 in case of success, otherwise -1
+ */
+int open_branch_counters(branch_counters_t *counters)
+{
+    assert(counters != NULL);
+
+#ifdef __linux__
+    counters->branches_fd = open_perf_event(PERF_COUNT_HW_BRANCH_INSTRUCTIONS);
+
+    if (counters->branches_fd == -1) {
+        return -1;
+    }
+
+    counters->misses_fd = open_perf_event(PERF_COUNT_HW_BRANCH_MISSES);
+
+    if (counters->misses_fd == -1) {
+        close(counters->branches_fd);
+        return -1;
+    }
+
+    return 0;
+#else
+    counters->branches_fd = counters->misses_fd = -1;
+
+    return -1;
+#endif
+}
+
+/*!
+ * Opens hardware counter of the process and the threads it creates in user space by perf_event_open
+ *
+ * @param config [in] the hardware event
+ *
+ * @return file descriptor of the counter in case of success, otherwise -1
+ */
+int open_perf_event(uint64_t config)
+{
+#ifdef __linux__
+    perf_event_attr attr = {};
+
+    attr.type           = PERF_TYPE_HARDWARE;
+    attr.size           = sizeof(attr);
+    attr.config         = config;
+    attr.disabled       = 1;
+    attr.inherit        = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+
+    return (int) syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+    (void) config;
+
+    return -1;
+#endif
+}
+
+/*!
+ * Enables or disables the hardware counters of branches and branch misses
+ *
+ * @param counters [in] pointer to the counters
+ * @param enable [in] 1 for enabling the counters, 0 for disabling them
+ */
+void enable_branch_counters(const branch_counters_t *counters, int enable)
+{
+    assert(counters != NULL);
+
+#ifdef __linux__
+    unsigned long request = enable ? PERF_EVENT_IOC_ENABLE : PERF_EVENT_IOC_DISABLE;
+
+    ioctl(counters->branches_fd, request, 0);
+    ioctl(counters->misses_fd, request, 0);
+#else
+    (void) enable;
+#endif
+}
+
+/*!
+ * Reads and resets the hardware counters of branches and branch misses
+ *
+ * @param counters [in] pointer to the counters
+ * @param n_branches [out] pointer to the number of branches
+ * @param n_misses [out] pointer to the number of branch misses
+ *
+ * @return 0 in case of success, otherwise -1
+ */
+int read_branch_counters(const branch_counters_t *counters, uint64_t *n_branches, uint64_t *n_misses)
+{
+    assert(counters != NULL);
+    assert(n_branches != NULL);
+    assert(n_misses != NULL);
+
+#ifdef __linux__
+    if ((read(counters->branches_fd, n_branches, sizeof(*n_branches)) != sizeof(*n_branches)) ||
+        (read(counters->misses_fd, n_misses, sizeof(*n_misses)) != sizeof(*n_misses))) {
+        return -1;
+    }
+
+    ioctl(counters->branches_fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(counters->misses_fd, PERF_EVENT_IOC_RESET, 0);
+
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+/*!
+ * Closes the hardware counters of branches and branch misses
+ *
+ * @param counters [in] pointer to the counters
+ */
+void close_branch_counters(branch_counters_t *counters)
+{
+    assert(counters != NULL);
+
+#ifdef __linux__
+    close(counters->branches_fd);
+    close(counters->misses_fd);
+#endif
+
+    counters->branches_fd = counters->misses_fd = -1;
+}
+
+/*!
+ * Serves requests to solve square equations from stdin or clients of Unix socket until the end of stdin or QUIT
+ * request. Each request is a line of a, b, c coefficients, it's answered by a line like in the output file
+ *
+ * @param socket_path [in] path of the Unix socket or NULL for serving stdin and answering to stdout
+ * @param batch_size [in] the maximum number of requests solved at a time
+ * @param latency_budget_us [in] the time in microseconds, for which the first pending request waits for more
+ *
+ * @return 0 in case of success, otherwise -1
+ *
+ * @note Requests of all clients are gathered into micro-batches solved by solve_square_batch, the answers are sent
+ * in the order of the requests of each client. The sockets of the clients are non-blocking, so a client, which
+ * doesn't read its answers, doesn't stall the others
+ */
+int run_solve_square_server(const char *socket_path, size_t batch_size, long latency_budget_us)
+{
+    assert(batch_size > 0);
+    assert(latency_budget_us >= 0);
+
+#ifdef _WIN32
+    (void) socket_path;
+
+    fprintf(stderr, "ERROR: server mode is not supported on Windows\n");
+    return -1;
+#else
+    signal(SIGPIPE, SIG_IGN);
+
+    int listen_fd = -1;
+    std::vector<server_client_t> clients;
+
+    if (socket_path == NULL) {
+        clients.push_back({STDIN_FILENO, STDOUT_FILENO, {}, {}, 0, 0, 0});
+    } else {
+        listen_fd = open_server_socket(socket_path);
+
+        if (listen_fd == -1) {
+            fprintf(stderr, "ERROR: failed to listen on socket \"%s\"\n", socket_path);
+            return -1;
+        }
+    }
+
+    server_batch_t batch = {};
+    init_server_batch(&batch, batch_size);
+
+    int is_running = 1, error_flag = 0;
+
+    std::vector<pollfd> fds;
+
+    while (is_running) {
+        fds.clear();
+
+        if (listen_fd != -1) {
+            fds.push_back({listen_fd, POLLIN, 0});
+        }
+
+        /*
+         * Each client has a pair of entries: its input is polled until it's closed unless it doesn't read its answers,
+         * its output is polled while it has answers
+         */
+        for (size_t client_i = 0; client_i < clients.size(); ++client_i) {
+            const server_client_t *client = &clients[client_i];
+            int is_reading = !client->is_closed && (client->output.size() < MAX_SERVER_OUTPUT_SIZE);
+
+            fds.push_back({is_reading ? client->in_fd : -1, POLLIN, 0});
+            fds.push_back({client->output.empty() ? -1 : client->out_fd, POLLOUT, 0});
+        }
+
+        long timeout_us = -1;
+
+        if (batch.n_requests != 0) {
+            long age_us = get_server_batch_age_us(&batch);
+
+            timeout_us = (age_us < latency_budget_us) ? latency_budget_us - age_us : 0;
+        }
+
+        int n_ready = wait_for_requests(fds.data(), fds.size(), timeout_us);
+
+        if (n_ready == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            fprintf(stderr, "ERROR: failed to wait for requests\n");
+            error_flag = 1;
+            break;
+        }
+
+        size_t fd_i = 0, n_polled_clients = clients.size();
+
+        if (listen_fd != -1) {
+            if (fds[fd_i++].revents & POLLIN) {
+                int client_fd = accept(listen_fd, NULL, NULL);
+
+                if (client_fd != -1) {
+                    fcntl(client_fd, F_SETFL, fcntl(client_fd, F_GETFL) | O_NONBLOCK);
+
+                    clients.push_back({client_fd, client_fd, {}, {}, 0, 0, 0});
+                }
+            }
+        }
+
+        for (size_t client_i = 0; client_i < n_polled_clients; ++client_i, fd_i += 2) {
+            if (fds[fd_i + 1].revents & (POLLOUT | POLLHUP | POLLERR)) {
+                write_server_output(&clients[client_i]);
+            }
+
+            if ((fds[fd_i].revents & (POLLIN | POLLHUP | POLLERR)) &&
+                (read_server_requests(&clients, client_i, &batch) == 2)) {
+                is_running = 0;
+            }
+        }
+
+        if ((batch.n_requests != 0) && (get_server_batch_age_us(&batch) >= latency_budget_us)) {
+            flush_server_batch(&clients, &batch);
+        }
+
+        if ((socket_path == NULL) && clients[0].is_closed) {
+            is_running = 0;
+        }
+
+        int has_finished_clients = 0;
+
+        for (size_t client_i = 0; client_i < clients.size(); ++client_i) {
+            if (!clients[client_i].output.empty()) {
+                write_server_output(&clients[client_i]);
+            }
+
+            if (clients[client_i].is_closed && clients[client_i].output.empty()) {
+                has_finished_clients = 1;
+            }
+        }
+
+        if (has_finished_clients && (socket_path != NULL)) {
+            /* The batch refers to the clients by their indices, so they are removed only when it's empty */
+            flush_server_batch(&clients, &batch);
+
+            for (size_t client_i = clients.size(); client_i-- > 0;) {
+                if (clients[client_i].is_closed && clients[client_i].output.empty()) {
+                    close(clients[client_i].in_fd);
+                    clients.erase(clients.begin() + (ptrdiff_t) client_i);
+                }
+            }
+        }
+    }
+
+    flush_server_batch(&clients, &batch);
+    drain_server_output(&clients);
+
+    if (listen_fd != -1) {
+        for (size_t client_i = 0; client_i < clients.size(); ++client_i) {
+            close(clients[client_i].in_fd);
+        }
+
+        close(listen_fd);
+        unlink(socket_path);
+    }
+
+    return error_flag ? -1 : 0;
+#endif
+}
+
+#ifndef _WIN32
+/*!
+ * Creates Unix socket listening for the clients of the server
+ *
+ * @param socket_path [in] path of the socket
+ *
+ * @return file descriptor of the socket in case of success, otherwise -1
+ *
+ * @note A socket left at the path by a server, which didn't stop properly, is replaced. Any other file or a socket
+ * of a running server at the path makes it fail
+ */
+int open_server_socket(const char *socket_path)
+{
+    assert(socket_path != NULL);
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+
+    if (strlen(socket_path) >= sizeof(address.sun_path)) {
+        return -1;
+    }
+
+    strcpy(address.sun_path, socket_path);
+
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (listen_fd == -1) {
+        return -1;
+    }
+
+    struct stat file_stat = {};
+
+    if (lstat(socket_path, &file_stat) == 0) {
+        if (!S_ISSOCK(file_stat.st_mode)) {
+            fprintf(stderr, "ERROR: \"%s\" exists and is not a socket\n", socket_path);
+
+            close(listen_fd);
+            return -1;
+        }
+
+        int probe_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        int is_alive = (probe_fd == -1) || (connect(probe_fd, (const sockaddr *) &address, sizeof(address)) == 0);
+
+        if (probe_fd != -1) {
+            close(probe_fd);
+        }
+
+        if (is_alive) {
+            fprintf(stderr, "ERROR: a server may be running on socket \"%s\"\n", socket_path);
+
+            close(listen_fd);
+            return -1;
+        }
+
+        unlink(socket_path);
+    }
+
+    if ((bind(listen_fd, (const sockaddr *) &address, sizeof(address)) == -1) || (listen(listen_fd, SOMAXCONN) == -1)) {
+        close(listen_fd);
+        return -1;
+    }
+
+    return listen_fd;
+}
+
+/*!
+ * Waits for the file descriptors to become ready with microsecond timeout
+ *
+ * @param fds [in, out] array of the file descriptors
+ * @param n_fds [in] the number of file descriptors
+ * @param timeout_us [in] timeout in microseconds or -1 for no timeout
+ *
+ * @return the number of ready file descriptors, 0 in case of timeout, -1 in case of error
+ *
+ * @note Without ppoll the timeout is rounded up to milliseconds
+ */
+int wait_for_requests(pollfd *fds, size_t n_fds, long timeout_us)
+{
+    assert(fds != NULL);
+
+#ifdef __linux__
+    timespec timeout = {timeout_us / 1000000, (timeout_us % 1000000) * 1000};
+
+    return ppoll(fds, (nfds_t) n_fds, (timeout_us < 0) ? NULL : &timeout, NULL);
+#else
+    return poll(fds, (nfds_t) n_fds, (timeout_us < 0) ? -1 : (int) ((timeout_us + 999) / 1000));
+#endif
+}
+
+/*!
+ * Allocates the arrays of an empty batch of the server
+ *
+ * @param batch [out] pointer to the batch
+ * @param batch_size [in] the maximum number of requests in the batch
+ */
+void init_server_batch(server_batch_t *batch, size_t batch_size)
+{
+    assert(batch != NULL);
+    assert(batch_size > 0);
+
+    batch->a.resize(batch_size);
+    batch->b.resize(batch_size);
+    batch->c.resize(batch_size);
+    batch->root1.resize(batch_size);
+    batch->root2.resize(batch_size);
+    batch->n_roots.resize(batch_size);
+    batch->client_i.resize(batch_size);
+    batch->is_valid.resize(batch_size);
+
+    batch->n_requests = 0;
+}
+
+/*!
+ * Gets the time, for which the first request of a non-empty batch of the server has been waiting
+ *
+ * @param batch [in] pointer to the batch
+ *
+ * @return the time in microseconds
+ */
+long get_server_batch_age_us(const server_batch_t *batch)
+{
+    assert(batch != NULL);
+    assert(batch->n_requests != 0);
+
+    return (long) std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now() - batch->start).count();
+}
+
+/*!
+ * Reads the available requests of a client of the server and adds them to the batch, which is flushed when full
+ *
+ * @param clients [in, out] pointer to the clients
+ * @param client_i [in] index of the client
+ * @param batch [in, out] pointer to the batch
+ *
+ * @return 0 if the client is open, 1 if it's closed, 2 if it requested the server to quit
+ *
+ * @note The last line is served at the end of input even if it's not terminated. A line longer than MAX_REQUEST_LEN
+ * is answered as an invalid request once, the rest of it is skipped up to the next newline
+ */
+int read_server_requests(std::vector<server_client_t> *clients, size_t client_i, server_batch_t *batch)
+{
+    assert(clients != NULL);
+    assert(client_i < clients->size());
+    assert(batch != NULL);
+
+    server_client_t *client = &(*clients)[client_i];
+
+    size_t size = client->input.size();
+    client->input.resize(size + SERVER_READ_SIZE);
+
+    ssize_t n_read = read(client->in_fd, client->input.data() + size, SERVER_READ_SIZE);
+
+    if ((n_read == -1) && ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR))) {
+        client->input.resize(size);
+        return 0;
+    }
+
+    if (n_read <= 0) {
+        client->is_closed = 1;
+        client->input.resize(size);
+
+        if (size != 0) {
+            client->input.push_back('\n');
+        }
+    } else {
+        client->input.resize(size + (size_t) n_read);
+    }
+
+    int status = client->is_closed ? 1 : 0;
+
+    const char *begin = client->input.data(), *end = begin + client->input.size(), *line = begin;
+
+    while (line < end) {
+        const char *line_end = (const char *) memchr(line, '\n', (size_t) (end - line));
+
+        if (client->is_skipping_line) {
+            if (line_end == NULL) {
+                line = end;
+                break;
+            }
+
+            client->is_skipping_line = 0;
+            line = line_end + 1;
+            continue;
+        }
+
+        if (line_end == NULL) {
+            if ((size_t) (end - line) <= MAX_REQUEST_LEN) {
+                break;
+            }
+
+            add_server_request(batch, client_i, NULL, NULL);
+
+            client->is_skipping_line = 1;
+            line = end;
+        } else if ((line_end - line >= 4) && (strncmp(line, "QUIT", 4) == 0) &&
+                   (line_end - line == 4 || ((line_end - line == 5) && (line[4] == '\r')))) {
+            status = 2;
+            line = end;
+            break;
+        } else {
+            int is_too_long = ((size_t) (line_end - line) > MAX_REQUEST_LEN);
+
+            add_server_request(batch, client_i, is_too_long ? NULL : line, line_end);
+
+            line = line_end + 1;
+        }
+
+        if (batch->n_requests == batch->a.size()) {
+            flush_server_batch(clients, batch);
+        }
+    }
+
+    client->input.erase(client->input.begin(), client->input.begin() + (line - begin));
+
+    return status;
+}
+
+/*!
+ * Adds request of a client of the server to the batch, which must not be full
+ *
+ * @param batch [in, out] pointer to the batch
+ * @param client_i [in] index of the client
+ * @param line [in] pointer to the beginning of the request line or NULL for an invalid request
+ * @param line_end [in] pointer to the end of the request line
+ *
+ * @note Empty lines aren't requests, so they are skipped
+ */
+void add_server_request(server_batch_t *batch, size_t client_i, const char *line, const char *line_end)
+{
+    assert(batch != NULL);
+    assert(batch->n_requests < batch->a.size());
+
+    size_t request_i = batch->n_requests;
+
+    int is_valid = 0;
+
+    if (line != NULL) {
+        parse_chunk_t chunk = {line, line_end, request_i, 0, NULL};
+
+        parse_coefficients(&chunk, batch->a.data(), batch->b.data(), batch->c.data());
+
+        if ((chunk.n_equations == 0) && (chunk.error_line == NULL)) {
+            return;
+        }
+
+        is_valid = (chunk.error_line == NULL);
+    }
+
+    batch->is_valid[request_i] = (char) is_valid;
+
+    if (!is_valid) {
+        batch->a[request_i] = batch->b[request_i] = batch->c[request_i] = 0;
+    }
+
+    batch->client_i[request_i] = client_i;
+
+    if (request_i == 0) {
+        batch->start = std::chrono::steady_clock::now();
+    }
+
+    ++batch->n_requests;
+}
+
+/*!
+ * Solves the requests of the batch and appends the answers to the output of the clients in the order of the requests
+ *
+ * @param clients [in, out] pointer to the clients
+ * @param batch [in, out] pointer to the batch, which becomes empty
+ *
+ * @note The answers are sent by write_server_output, the answers to the clients with broken output are dropped
+ */
+void flush_server_batch(std::vector<server_client_t> *clients, server_batch_t *batch)
+{
+    assert(clients != NULL);
+    assert(batch != NULL);
+
+    if (batch->n_requests == 0) {
+        return;
+    }
+
+    solve_square_batch(batch->a.data(), batch->b.data(), batch->c.data(), batch->n_requests,
+                       batch->n_roots.data(), batch->root1.data(), batch->root2.data());
+
+    for (size_t request_i = 0; request_i < batch->n_requests; ++request_i) {
+        server_client_t *client = &(*clients)[batch->client_i[request_i]];
+
+        if (client->is_output_broken) {
+            continue;
+        }
+
+        if (!batch->is_valid[request_i]) {
+            client->output.insert(client->output.end(), INVALID_REQUEST_RESPONSE,
+                                  INVALID_REQUEST_RESPONSE + sizeof(INVALID_REQUEST_RESPONSE) - 1);
+            continue;
+        }
+
+        char solution[MAX_SOLUTION_LEN] = "";
+        char *solution_end = format_solution(solution, batch->n_roots[request_i],
+                                             batch->root1[request_i], batch->root2[request_i]);
+
+        client->output.insert(client->output.end(), solution, solution_end);
+    }
+
+    batch->n_requests = 0;
+}
+
+/*!
+ * Writes the pending answers of a client of the server as far as its output accepts them without blocking
+ *
+ * @param client [in, out] pointer to the client
+ *
+ * @return 0 in case of success, otherwise -1
+ *
+ * @note In case of error the client is marked as closed and its pending answers are dropped
+ */
+int write_server_output(server_client_t *client)
+{
+    assert(client != NULL);
+
+    if (client->output.empty()) {
+        return 0;
+    }
+
+    ssize_t n_written = write(client->out_fd, client->output.data(), client->output.size());
+
+    if (n_written == -1) {
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) {
+            return 0;
+        }
+
+        client->is_closed = client->is_output_broken = 1;
+        client->output.clear();
+
+        return -1;
+    }
+
+    client->output.erase(client->output.begin(), client->output.begin() + n_written);
+
+    return 0;
+}
+
+/*!
+ * Writes the pending answers of the clients of the server before it quits
+ *
+ * @param clients [in, out] pointer to the clients
+ *
+ * @note The clients, which don't read their answers within SERVER_SHUTDOWN_TIMEOUT_US, lose them
+ */
+void drain_server_output(std::vector<server_client_t> *clients)
+{
+    assert(clients != NULL);
+
+    std::vector<pollfd> fds(clients->size());
+
+    for (;;) {
+        int has_output = 0;
+
+        for (size_t client_i = 0; client_i < clients->size(); ++client_i) {
+            const server_client_t *client = &(*clients)[client_i];
+
+            fds[client_i] = {client->output.empty() ? -1 : client->out_fd, POLLOUT, 0};
+
+            has_output |= !client->output.empty();
+        }
+
+        if (!has_output) {
+            return;
+        }
+
+        int n_ready = wait_for_requests(fds.data(), fds.size(), SERVER_SHUTDOWN_TIMEOUT_US);
+
+        if ((n_ready == -1) && (errno == EINTR)) {
+            continue;
+        }
+
+        if (n_ready <= 0) {
+            return;
+        }
+
+        for (size_t client_i = 0; client_i < clients->size(); ++client_i) {
+            if (fds[client_i].revents & (POLLOUT | POLLHUP | POLLERR)) {
+                write_server_output(&(*clients)[client_i]);
+            }
+        }
+    }
+}
+#endif
+
+/*!
+ * Tests a case
+ *
+ * @param [in] name name of test case
+ * @param [in] expr expression to be tested
+ *
+ * @return 1 if expr is true, otherwise 0
+ */
+int test_case(const char *name, int expr)
+{
+    if (expr) {
+        printf("\ttest \"%s\" passed\n", name);
+        return 1;
+    } else {
+        printf("\ttest \"%s\" failed\n", name);
+        return 0;
+    }
+}
+
+/*!
+ * Generates coefficients of test equations: every other equation has coefficients picked from special values, such
+ * as 0, values on both sides of the tolerances and values out of single precision range, and the others have
+ * uniformly distributed coefficients in [-10, 10]
+ *
+ * @param a [out] array of quadratic coefficients
+ * @param b [out] array of linear coefficients
+ * @param c [out] array of free terms
+ * @param n [in] the number of equations
+ * @param seed [in] the seed of the random number generator, so that each test gets its own equations
+ */
+void generate_test_coefficients(double *a, double *b, double *c, size_t n, unsigned seed)
+{
+    assert(a != NULL);
+    assert(b != NULL);
+    assert(c != NULL);
+
+    static const double SPECIAL_COEFFICIENTS[] = {0, 1, -1, 2, -2, 0.5, 4, EPS / 2, -EPS / 2, 1e-9, EPS_F / 2, 1e-4,
+                                                  1e6, 1e30, 1e40};
+    const size_t N_SPECIAL_COEFFICIENTS = sizeof(SPECIAL_COEFFICIENTS) / sizeof(SPECIAL_COEFFICIENTS[0]);
+
+    srand(seed);
+
+    for (size_t i = 0; i < n; ++i) {
+        if (i % 2) {
+            a[i] = SPECIAL_COEFFICIENTS[rand() % N_SPECIAL_COEFFICIENTS];
+            b[i] = SPECIAL_COEFFICIENTS[rand() % N_SPECIAL_COEFFICIENTS];
+            c[i] = SPECIAL_COEFFICIENTS[rand() % N_SPECIAL_COEFFICIENTS];
+        } else {
+            a[i] = 20.0 * rand() / RAND_MAX - 10;
+            b[i] = 20.0 * rand() / RAND_MAX - 10;
+            c[i] = 20.0 * rand() / RAND_MAX - 10;
+        }
+    }
+}
+
+/*!
+ * Tests solve_square function
+ */
+void test_solve_square(void)
+{
+    printf("Testing solve_square function:\n");
+
+    double root1 = 0, root2 = 0;
+
+    int n_tests_passed = 0, n_tests_failed = 0;
+
+#define TEST_CASE(name, expr) (test_case((name), (expr)) ? ++n_tests_passed : ++n_tests_failed)
+
+    TEST_CASE("infinite number of roots",
+              solve_square(0, 0, 0, &root1, &root2) == INF_ROOTS);
+    TEST_CASE("0 roots, constant equation",
+              solve_square(0, 0, 1, &root1, &root2) == 0);
+    TEST_CASE("0 roots, quadratic equation",
+              solve_square(1, 1, 1, &root1, &root2) == 0);
+    TEST_CASE("1 root, linear equation, number of roots",
+              solve_square(0, 1, 1, &root1, &root2) == 1);
+    TEST_CASE("1 root, linear equation, correctness of roots",
+              are_almost_equal(root1, root2) && are_almost_equal(root1, -1));
+    TEST_CASE("1 root, quadratic equation, number of roots",
+              solve_square(1, -2, 1, &root1, &root2) == 1);
+    TEST_CASE("1 root, quadratic equation, correctness of roots",
+              are_almost_equal(root1, root2) && are_almost_equal(root1, 1));
+    TEST_CASE("2 roots, number of roots",
+              solve_square(2, 5, 3, &root1, &root2) == 2);
+    TEST_CASE("2 roots, correctness of roots",
+              are_almost_equal(root1, -1) && are_almost_equal(root2, -1.5));
+
+#undef TEST_CASE
+
+    printf("Finished testing solve_square function: %d tests passed, %d tests failed. The"
+           "total number of tests was: %d\n",
+           n_tests_passed, n_tests_failed, n_tests_passed + n_tests_failed);
+}
+
+/*!
+ * Tests solve_square_batch function and each of its kernels supported by the CPU against solve_square
+ */
+void test_solve_square_batch(void)
+{
+    printf("Testing solve_square_batch function:\n");
+
+    const size_t N_EQUATIONS = 1027;
+
+    double a[N_EQUATIONS] = {}, b[N_EQUATIONS] = {}, c[N_EQUATIONS] = {};
+
+    generate_test_coefficients(a, b, c, N_EQUATIONS, 1);
+
+    int expected_n_roots[N_EQUATIONS] = {};
+    double expected_root1[N_EQUATIONS] = {}, expected_root2[N_EQUATIONS] = {};
+
+    for (size_t i = 0; i < N_EQUATIONS; ++i) {
+        expected_n_roots[i] = solve_square(a[i], b[i], c[i], &expected_root1[i], &expected_root2[i]);
+
+        if ((expected_n_roots[i] == 0) || (expected_n_roots[i] == INF_ROOTS)) {
+            expected_root1[i] = expected_root2[i] = 0;
+        }
+    }
+
+    struct {
+        const char *name;
+        solve_square_batch_kernel_t *kernel;
+    } kernels[] = {
+        {"dispatched", solve_square_batch},
+        {"scalar",     solve_square_batch_scalar},
+#ifdef SOLVE_SQUARE_X86_KERNELS
+        {"SSE2",       __builtin_cpu_supports("sse2")    ? solve_square_batch_sse2   : NULL},
+        {"AVX2",       __builtin_cpu_supports("avx2")    ? solve_square_batch_avx2   : NULL},
+        {"AVX-512",    __builtin_cpu_supports("avx512f") ? solve_square_batch_avx512 : NULL},
+#endif
+    };
+
+    int n_tests_passed = 0, n_tests_failed = 0;
+
+    for (size_t kernel_i = 0; kernel_i < sizeof(kernels) / sizeof(kernels[0]); ++kernel_i) {
+        if (kernels[kernel_i].kernel == NULL) {
+            printf("\ttest \"%s kernel\" skipped, not supported by the CPU\n", kernels[kernel_i].name);
+            continue;
+        }
+
+        int n_roots[N_EQUATIONS] = {};
+        double root1[N_EQUATIONS] = {}, root2[N_EQUATIONS] = {};
+
+        (*kernels[kernel_i].kernel)(a, b, c, N_EQUATIONS, n_roots, root1, root2);
+
+        int are_equal = 1;
+
+        for (size_t i = 0; i < N_EQUATIONS; ++i) {
+            if ((n_roots[i] != expected_n_roots[i]) || (root1[i] != expected_root1[i]) ||
+                (root2[i] != expected_root2[i])) {
+                are_equal = 0;
+            }
+        }
+
+        char name[64] = "";
+        snprintf(name, sizeof(name), "%s kernel matches solve_square", kernels[kernel_i].name);
+
+        (test_case(name, are_equal) ? ++n_tests_passed : ++n_tests_failed);
+    }
+
+    printf("Finished testing solve_square_batch function: %d tests passed, %d tests failed. The "
+           "total number of tests was: %d\n",
+           n_tests_passed, n_tests_failed, n_tests_passed + n_tests_failed);
+}
+
+/*!
+ * Tests solve_square_batch_parallel function against solve_square_batch
+ */
+void test_solve_square_batch_parallel(void)
+{
+    printf("Testing solve_square_batch_parallel function:\n");
+
+    const size_t N_EQUATIONS = 3 * PARALLEL_BLOCK_SIZE + 5;
+
+    std::vector<double> a(N_EQUATIONS), b(N_EQUATIONS), c(N_EQUATIONS);
+
+    srand(2);
+
+    for (size_t i = 0; i < N_EQUATIONS; ++i) {
+        a[i] = (i % 7 == 0) ? 0 : 20.0 * rand() / RAND_MAX - 10;
+        b[i] = (i % 11 == 0) ? 0 : 20.0 * rand() / RAND_MAX - 10;
+        c[i] = (i % 13 == 0) ? 0 : 20.0 * rand() / RAND_MAX - 10;
+    }
+
+    std::vector<int> expected_n_roots(N_EQUATIONS), n_roots(N_EQUATIONS);
+    std::vector<double> expected_root1(N_EQUATIONS), expected_root2(N_EQUATIONS),
+                        root1(N_EQUATIONS), root2(N_EQUATIONS);
+
+    solve_square_batch(a.data(), b.data(), c.data(), N_EQUATIONS,
+                       expected_n_roots.data(), expected_root1.data(), expected_root2.data());
+
+    root_count_stats_t expected_stats = {};
+    count_roots(expected_n_roots.data(), N_EQUATIONS, &expected_stats);
+
+    int n_tests_passed = 0, n_tests_failed = 0;
+
+    for (size_t n_threads = 1; n_threads <= 4; n_threads *= 2) {
+        root_count_stats_t stats = {};
+
+        solve_square_batch_parallel(a.data(), b.data(), c.data(), N_EQUATIONS,
+                                    n_roots.data(), root1.data(), root2.data(), n_threads, &stats);
+
+        char name[64] = "";
+
+        snprintf(name, sizeof(name), "%zu threads, solutions", n_threads);
+        (test_case(name, (n_roots == expected_n_roots) && (root1 == expected_root1) && (root2 == expected_root2))
+         ? ++n_tests_passed : ++n_tests_failed);
+
+        snprintf(name, sizeof(name), "%zu threads, root count statistics", n_threads);
+        (test_case(name, memcmp(&stats, &expected_stats, sizeof(stats)) == 0) ? ++n_tests_passed : ++n_tests_failed);
+    }
+
+    printf("Finished testing solve_square_batch_parallel function: %d tests passed, %d tests failed. The "
+           "total number of tests was: %d\n",
+           n_tests_passed, n_tests_failed, n_tests_passed + n_tests_failed);
+}
+
+/*!
+ * Tests parse_coefficients and format_solution functions: parsing of valid and invalid lines, and the round trip
+ * of formatted solutions through the parser
+ */
+void test_parse_coefficients(void)
+{
+    printf("Testing parse_coefficients and format_solution functions:\n");
+
+    int n_tests_passed = 0, n_tests_failed = 0;
+
+#define TEST_CASE(name, expr) (test_case((name), (expr)) ? ++n_tests_passed : ++n_tests_failed)
+
+    double a[4] = {}, b[4] = {}, c[4] = {};
+
+    const char valid[] = "1 -3 2\r\n\n+0.5,+2;-1e-3\n\t-0 +0 1e300";
+    parse_chunk_t chunk = {valid, valid + strlen(valid), 0, 0, NULL};
+
+    parse_coefficients(&chunk, a, b, c);
+
+    TEST_CASE("valid lines, number of equations",
+              (chunk.error_line == NULL) && (chunk.n_equations == 3));
+    TEST_CASE("valid lines, coefficients",
+              (a[0] == 1) && (b[0] == -3) && (c[0] == 2) && (a[1] == 0.5) && (b[1] == 2) && (c[1] == -1e-3) &&
+              (a[2] == 0) && signbit(a[2]) && (b[2] == 0) && (c[2] == 1e300));
+
+    const char *invalid[][2] = {
+        {"too few coefficients",    "1 2 3\n1 2\n"},
+        {"too many coefficients",   "1 2 3\n1 2 3 4\n"},
+        {"not a number",            "1 2 3\n1 x 3\n"},
+        {"not finite",              "1 2 3\n1 inf 3\n"},
+        {"out of range",            "1 2 3\n1 1e400 3\n"},
+        {"plus before minus",       "1 2 3\n1 +-2 3\n"},
+        {"double plus",             "1 2 3\n1 ++2 3\n"},
+        {"lone plus",               "1 2 3\n1 2 +\n"},
+        {"no separator",            "1 2 3\n1-2 3\n"},
+        {"trailing garbage",        "1 2 3\n1 2 3x\n"},
+    };
+
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i) {
+        chunk = {invalid[i][1], invalid[i][1] + strlen(invalid[i][1]), 0, 0, NULL};
+
+        parse_coefficients(&chunk, a, b, c);
+
+        char name[64] = "";
+        snprintf(name, sizeof(name), "invalid line, %s", invalid[i][0]);
+
+        TEST_CASE(name, (chunk.error_line == invalid[i][1] + strlen("1 2 3\n")) && (chunk.n_equations == 1));
+    }
+
+    char formatted[3 * MAX_SOLUTION_LEN] = "";
+
+    char *writer = format_solution(formatted, INF_ROOTS, 0, 0);
+    writer = format_solution(writer, 0, 0, 0);
+    writer = format_solution(writer, 1, -0.1, -0.1);
+
+    TEST_CASE("formatting of special root numbers",
+              (writer - formatted == (ptrdiff_t) strlen("inf\n0\n1 -0.1\n")) &&
+              (memcmp(formatted, "inf\n0\n1 -0.1\n", strlen("inf\n0\n1 -0.1\n")) == 0));
+
+    srand(13);
+
+    int is_round_trip_exact = 1;
+
+    for (size_t i = 0; (i < 1000) && is_round_trip_exact; ++i) {
+        double root1 = get_random_coefficient(-300, 300) / 3, root2 = -get_random_coefficient(-300, 300) / 7;
+
+        writer = format_solution(formatted, 2, root1, root2);
+
+        chunk = {formatted, writer, 0, 0, NULL};
+
+        parse_coefficients(&chunk, a, b, c);
+
+        is_round_trip_exact = (chunk.error_line == NULL) && (chunk.n_equations == 1) && (a[0] == 2) &&
+                              (b[0] == root1) && (c[0] == root2);
+    }
+
+    TEST_CASE("round trip of formatted roots through the parser", is_round_trip_exact);
+
+#undef TEST_CASE
+
+    printf("Finished testing parse_coefficients and format_solution functions: %d tests passed, %d tests failed. The "
+           "total number of tests was: %d\n",
+           n_tests_passed, n_tests_failed, n_tests_passed + n_tests_failed);
+}
+
+/*!
+ * Tests single precision and mixed precision solvers: solve_square_batch_f kernels against solve_square_f, and
+ * solve_square_batch_mixed against solve_square
+ */
+void test_solve_square_float(void)
+{
+    printf("Testing single and mixed precision solvers:\n");
+
+    const size_t N_EQUATIONS = 1031;
+
+    double a[N_EQUATIONS] = {}, b[N_EQUATIONS] = {}, c[N_EQUATIONS] = {};
+    float a_f[N_EQUATIONS] = {}, b_f[N_EQUATIONS] = {}, c_f[N_EQUATIONS] = {};
+
+    generate_test_coefficients(a, b, c, N_EQUATIONS, 3);
+
+    for (size_t i = 0; i < N_EQUATIONS; ++i) {
+        a_f[i] = (float) ((fabs(a[i]) < 1e6) ? a[i] : 1e6);
+        b_f[i] = (float) ((fabs(b[i]) < 1e6) ? b[i] : 1e6);
+        c_f[i] = (float) ((fabs(c[i]) < 1e6) ? c[i] : 1e6);
+    }
+
+    int expected_n_roots[N_EQUATIONS] = {};
+    float expected_root1_f[N_EQUATIONS] = {}, expected_root2_f[N_EQUATIONS] = {};
+
+    for (size_t i = 0; i < N_EQUATIONS; ++i) {
+        expected_n_roots[i] = solve_square_f(a_f[i], b_f[i], c_f[i], &expected_root1_f[i], &expected_root2_f[i]);
+
+        if ((expected_n_roots[i] == 0) || (expected_n_roots[i] == INF_ROOTS)) {
+            expected_root1_f[i] = expected_root2_f[i] = 0;
+        }
+    }
+
+    struct {
+        const char *name;
+        solve_square_batch_f_kernel_t *kernel;
+    } kernels[] = {
+        {"dispatched", solve_square_batch_f},
+        {"scalar",     solve_square_batch_f_scalar},
+#ifdef SOLVE_SQUARE_X86_KERNELS
+        {"SSE2",       __builtin_cpu_supports("sse2")    ? solve_square_batch_f_sse2   : NULL},
+        {"AVX2",       __builtin_cpu_supports("avx2")    ? solve_square_batch_f_avx2   : NULL},
+        {"AVX-512",    __builtin_cpu_supports("avx512f") ? solve_square_batch_f_avx512 : NULL},
+#endif
+    };
+
+    int n_tests_passed = 0, n_tests_failed = 0;
+
+    for (size_t kernel_i = 0; kernel_i < sizeof(kernels) / sizeof(kernels[0]); ++kernel_i) {
+        if (kernels[kernel_i].kernel == NULL) {
+            printf("\ttest \"%s single precision kernel\" skipped, not supported by the CPU\n", kernels[kernel_i].name);
+            continue;
+        }
+
+        int n_roots[N_EQUATIONS] = {};
+        float root1[N_EQUATIONS] = {}, root2[N_EQUATIONS] = {};
+
+        (*kernels[kernel_i].kernel)(a_f, b_f, c_f, N_EQUATIONS, n_roots, root1, root2);
+
+        int are_equal = 1;
+
+        for (size_t i = 0; i < N_EQUATIONS; ++i) {
+            if ((n_roots[i] != expected_n_roots[i]) || (root1[i] != expected_root1_f[i]) ||
+                (root2[i] != expected_root2_f[i])) {
+                are_equal = 0;
+            }
+        }
+
+        char name[64] = "";
+        snprintf(name, sizeof(name), "%s single precision kernel matches solve_square_f", kernels[kernel_i].name);
+
+        (test_case(name, are_equal) ? ++n_tests_passed : ++n_tests_failed);
+    }
+
+    int n_roots[N_EQUATIONS] = {};
+    double root1[N_EQUATIONS] = {}, root2[N_EQUATIONS] = {};
+
+    solve_square_batch_mixed(a, b, c, N_EQUATIONS, n_roots, root1, root2);
+
+    int are_n_roots_equal = 1, are_roots_accurate = 1;
+
+    for (size_t i = 0; i < N_EQUATIONS; ++i) {
+        double expected_root1 = 0, expected_root2 = 0;
+        int expected_n_roots_i = solve_square(a[i], b[i], c[i], &expected_root1, &expected_root2);
+
+        if (n_roots[i] != expected_n_roots_i) {
+            are_n_roots_equal = 0;
+        }
+
+        if ((n_roots[i] >= 1) &&
+            ((fabs(root1[i] - expected_root1) > MIXED_MAX_CANCELLATION * FLT_EPSILON * (fabs(expected_root1) + EPS)) ||
+             (fabs(root2[i] - expected_root2) > MIXED_MAX_CANCELLATION * FLT_EPSILON * (fabs(expected_root2) + EPS)))) {
+            are_roots_accurate = 0;
+        }
+    }
+
+    (test_case("mixed precision, number of roots", are_n_roots_equal) ? ++n_tests_passed : ++n_tests_failed);
+    (test_case("mixed precision, accuracy of roots", are_roots_accurate) ? ++n_tests_passed : ++n_tests_failed);
+
+    printf("Finished testing single and mixed precision solvers: %d tests passed, %d tests failed. The "
+           "total number of tests was: %d\n",
+           n_tests_passed, n_tests_failed, n_tests_passed + n_tests_failed);
+}
+
+/*!
+ * Tests solve_square_mapped function: writes a binary coefficient file through map_file, solves it and reads the
+ * binary solution file back, comparing the solutions against solve_square
+ */
+void test_solve_square_mapped(void)
+{
+    printf("Testing solve_square_mapped function:\n");
+
+    int n_tests_passed = 0, n_tests_failed = 0;
+
+#define TEST_CASE(name, expr) (test_case((name), (expr)) ? ++n_tests_passed : ++n_tests_failed)
+
+    const size_t N_EQUATIONS = 1029;
+
+#ifdef _WIN32
+    char temp_path[MAX_PATH] = "", input_file_name[MAX_PATH] = "", output_file_name[MAX_PATH] = "";
+
+    int is_created = (GetTempPathA(MAX_PATH, temp_path) != 0) &&
+                     (GetTempFileNameA(temp_path, "sqe", 0, input_file_name) != 0) &&
+                     (GetTempFileNameA(temp_path, "sqe", 0, output_file_name) != 0);
+#else
+    char input_file_name[]  = "/tmp/solve_square_mapped_XXXXXX",
+         output_file_name[] = "/tmp/solve_square_mapped_XXXXXX";
+
+    int input_fd = mkstemp(input_file_name), output_fd = mkstemp(output_file_name);
+    int is_created = (input_fd >= 0) && (output_fd >= 0);
+
+    if (input_fd >= 0) {
+        close(input_fd);
+    }
+
+    if (output_fd >= 0) {
+        close(output_fd);
+    }
+#endif
+
+    size_t column_size = get_binary_column_size(N_EQUATIONS, sizeof(double));
+
+    std::vector<double> a(N_EQUATIONS), b(N_EQUATIONS), c(N_EQUATIONS);
+
+    generate_test_coefficients(a.data(), b.data(), c.data(), N_EQUATIONS, 17);
+
+    int is_written = is_created && !write_test_coefficient_file(input_file_name, a.data(), b.data(), c.data(),
+                                                                N_EQUATIONS);
+
+    TEST_CASE("writing of the binary coefficient file", is_written);
+    TEST_CASE("solving of the binary coefficient file",
+              is_written && !solve_square_mapped(input_file_name, output_file_name));
+
+    mapped_file_t output = {};
+
+    size_t n_roots_column_size = get_binary_column_size(N_EQUATIONS, sizeof(int32_t));
+
+    int is_mapped = !map_file(output_file_name, 0, 0, &output);
+
+    TEST_CASE("size of the binary solution file",
+              is_mapped && (output.size == sizeof(binary_header_t) + n_roots_column_size + 2 * column_size));
+
+    if (is_mapped && (output.size == sizeof(binary_header_t) + n_roots_column_size + 2 * column_size)) {
+        const binary_header_t *output_header = (const binary_header_t *) output.data;
+
+        TEST_CASE("header of the binary solution file",
+                  (memcmp(output_header->magic, BINARY_OUTPUT_MAGIC, sizeof(BINARY_OUTPUT_MAGIC)) == 0) &&
+                  (output_header->version == BINARY_VERSION) && (output_header->n_equations == N_EQUATIONS));
+
+        const char *output_columns = (const char *) output.data + output_header->header_size;
+
+        const int32_t *n_roots = (const int32_t *) output_columns;
+        const double *root1 = (const double *) (output_columns + n_roots_column_size),
+                     *root2 = (const double *) (output_columns + n_roots_column_size + column_size);
+
+        size_t n_mismatches = 0;
+
+        for (size_t i = 0; i < N_EQUATIONS; ++i) {
+            double expected_root1 = 0, expected_root2 = 0;
+            int expected_n_roots = solve_square(a[i], b[i], c[i], &expected_root1, &expected_root2);
+
+            if ((n_roots[i] != expected_n_roots) ||
+                ((expected_n_roots >= 1) && !are_almost_equal(root1[i], expected_root1)) ||
+                ((expected_n_roots == 2) && !are_almost_equal(root2[i], expected_root2))) {
+                ++n_mismatches;
+            }
+        }
+
+        TEST_CASE("solutions read back from the binary solution file", n_mismatches == 0);
+    }
+
+    if (is_mapped) {
+        unmap_file(&output);
+    }
+
+    b[N_EQUATIONS / 2] = NAN;
+
+    TEST_CASE("rejection of a binary coefficient file with a NaN coefficient",
+              is_created && !write_test_coefficient_file(input_file_name, a.data(), b.data(), c.data(), N_EQUATIONS) &&
+              (solve_square_mapped(input_file_name, output_file_name) != 0));
+
+    TEST_CASE("rejection of a file which isn't a binary coefficient file",
+              solve_square_mapped(output_file_name, output_file_name) != 0);
+
+    remove(input_file_name);
+    remove(output_file_name);
+
+#undef TEST_CASE
+
+    printf("Finished testing solve_square_mapped function: %d tests passed, %d tests failed. The "
+           "total number of tests was: %d\n",
+           n_tests_passed, n_tests_failed, n_tests_passed + n_tests_failed);
+}
+
+/*!
+ * Writes a binary coefficient file through map_file
+ *
+ * @param file_name [in] name of the file, which is created or overwritten
+ * @param a [in] array of quadratic coefficients
+ * @param b [in] array of linear coefficients
+ * @param c [in] array of free terms
+ * @param n [in] the number of equations
+ *
+ * @return 0 in case of success, a non-zero value otherwise
+ */
+int write_test_coefficient_file(const char *file_name, const double *a, const double *b, const double *c, size_t n)
+{
+    assert(file_name != NULL);
+
+    size_t column_size = get_binary_column_size(n, sizeof(double));
+
+    mapped_file_t input = {};
+
+    if (map_file(file_name, sizeof(binary_header_t) + 3 * column_size, 1, &input)) {
+        return -1;
+    }
+
+    binary_header_t *input_header = (binary_header_t *) input.data;
+
+    memcpy(input_header->magic, BINARY_INPUT_MAGIC, sizeof(BINARY_INPUT_MAGIC));
+    input_header->version     = BINARY_VERSION;
+    input_header->header_size = sizeof(*input_header);
+    input_header->n_equations = n;
+
+    char *input_columns = (char *) input.data + sizeof(*input_header);
+
+    memcpy(input_columns, a, n * sizeof(double));
+    memcpy(input_columns + column_size, b, n * sizeof(double));
+    memcpy(input_columns + 2 * column_size, c, n * sizeof(double));
+
+    return unmap_file(&input);
+}
+
+/*!
+ * Tests classify_square and classify_square_batch functions against solve_square
+ */
+void test_classify_square(void)
+{
+    printf("Testing classify_square and classify_square_batch functions:\n");
+
+    const size_t N_EQUATIONS = 1029;
+
+    double a[N_EQUATIONS] = {}, b[N_EQUATIONS] = {}, c[N_EQUATIONS] = {};
+
+    generate_test_coefficients(a, b, c, N_EQUATIONS, 4);
+
+    int expected_n_roots[N_EQUATIONS] = {};
+
+    int are_scalar_equal = 1;
+
+    for (size_t i = 0; i < N_EQUATIONS; ++i) {
+        double root1 = 0, root2 = 0;
+        expected_n_roots[i] = solve_square(a[i], b[i], c[i], &root1, &root2);
+
+        if (classify_square(a[i], b[i], c[i]) != expected_n_roots[i]) {
+            are_scalar_equal = 0;
+        }
+    }
+
+    root_count_stats_t expected_stats = {};
+    count_roots(expected_n_roots, N_EQUATIONS, &expected_stats);
+
+    int n_tests_passed = 0, n_tests_failed = 0;
+
+    (test_case("classify_square matches solve_square", are_scalar_equal) ? ++n_tests_passed : ++n_tests_failed);
+
+    struct {
+        const char *name;
+        classify_square_batch_kernel_t *kernel;
+    } kernels[] = {
+        {"scalar",  classify_square_batch_scalar},
+#ifdef SOLVE_SQUARE_X86_KERNELS
+        {"SSE2",    __builtin_cpu_supports("sse2")    ? classify_square_batch_sse2   : NULL},
+        {"AVX2",    __builtin_cpu_supports("avx2")    ? classify_square_batch_avx2   : NULL},
+        {"AVX-512", __builtin_cpu_supports("avx512f") ? classify_square_batch_avx512 : NULL},
+#endif
+    };
+
+    for (size_t kernel_i = 0; kernel_i < sizeof(kernels) / sizeof(kernels[0]); ++kernel_i) {
+        if (kernels[kernel_i].kernel == NULL) {
+            printf("\ttest \"%s classification kernel\" skipped, not supported by the CPU\n", kernels[kernel_i].name);
+            continue;
+        }
+
+        int n_roots[N_EQUATIONS] = {};
+
+        (*kernels[kernel_i].kernel)(a, b, c, N_EQUATIONS, n_roots);
+
+        char name[64] = "";
+        snprintf(name, sizeof(name), "%s classification kernel matches solve_square", kernels[kernel_i].name);
+
+        int are_equal = (memcmp(n_roots, expected_n_roots, sizeof(n_roots)) == 0);
+
+        (test_case(name, are_equal) ? ++n_tests_passed : ++n_tests_failed);
+    }
+
+    root_count_stats_t stats = {};
+    classify_square_batch(a, b, c, N_EQUATIONS, NULL, &stats);
+
+    (test_case("classify_square_batch root count statistics", memcmp(&stats, &expected_stats, sizeof(stats)) == 0)
+     ? ++n_tests_passed : ++n_tests_failed);
+
+    printf("Finished testing classify_square and classify_square_batch functions: %d tests passed, %d tests failed. "
+           "The total number of tests was: %d\n",
+           n_tests_passed, n_tests_failed, n_tests_passed + n_tests_failed);
+}
+
+/*!
+ * Tests solve_cubic, solve_quartic, solve_cubic_batch and solve_quartic_batch functions
+ */
+void test_solve_cubic_quartic(void)
+{
+    printf("Testing solve_cubic and solve_quartic functions:\n");
+
+    double roots[4] = {};
+
+    int n_tests_passed = 0, n_tests_failed = 0;
+
+#define TEST_CASE(name, expr) (test_case((name), (expr)) ? ++n_tests_passed : ++n_tests_failed)
+
+    TEST_CASE("cubic, infinite number of roots",
+              solve_cubic(0, 0, 0, 0, roots) == INF_ROOTS);
+    TEST_CASE("cubic, square equation, number of roots",
+              solve_cubic(0, 1, -3, 2, roots) == 2);
+    TEST_CASE("cubic, square equation, correctness of roots",
+              are_almost_equal(roots[0], 2) && are_almost_equal(roots[1], 1));
+    TEST_CASE("cubic, 1 root, number of roots",
+              solve_cubic(1, 0, 0, -1, roots) == 1);
+    TEST_CASE("cubic, 1 root, correctness of roots",
+              are_almost_equal(roots[0], 1));
+    TEST_CASE("cubic, triple root, number of roots",
+              solve_cubic(1, -3, 3, -1, roots) == 1);
+    TEST_CASE("cubic, triple root, correctness of roots",
+              are_almost_equal(roots[0], 1));
+    TEST_CASE("cubic, double root, number of roots",
+              solve_cubic(1, 0, -3, 2, roots) == 2);
+    TEST_CASE("cubic, double root, correctness of roots",
+              are_almost_equal(roots[0], 1) && are_almost_equal(roots[1], -2));
+    TEST_CASE("cubic, 3 roots, number of roots",
+              solve_cubic(2, -4, -22, 24, roots) == 3);
+    TEST_CASE("cubic, 3 roots, correctness of roots",
+              are_almost_equal(roots[0], 4) && are_almost_equal(roots[1], 1) && are_almost_equal(roots[2], -3));
+
+    TEST_CASE("quartic, cubic equation, number of roots",
+              solve_quartic(0, 1, -6, 11, -6, roots) == 3);
+    TEST_CASE("quartic, cubic equation, correctness of roots",
+              are_almost_equal(roots[0], 3) && are_almost_equal(roots[1], 2) && are_almost_equal(roots[2], 1));
+    TEST_CASE("quartic, 0 roots",
+              solve_quartic(1, 0, 0, 0, 1, roots) == 0);
+    TEST_CASE("quartic, 0 roots, no biquadratic",
+              solve_quartic(1, 0, 1, 1, 1, roots) == 0);
+    TEST_CASE("quartic, biquadratic, number of roots",
+              solve_quartic(1, 0, -5, 0, 4, roots) == 4);
+    TEST_CASE("quartic, biquadratic, correctness of roots",
+              are_almost_equal(roots[0], 2) && are_almost_equal(roots[1], 1) &&
+              are_almost_equal(roots[2], -1) && are_almost_equal(roots[3], -2));
+    TEST_CASE("quartic, double root, number of roots",
+              solve_quartic(1, -4, 2, 4, -3, roots) == 3);
+    TEST_CASE("quartic, double root, correctness of roots",
+              are_almost_equal(roots[0], 3) && are_almost_equal(roots[1], 1) && are_almost_equal(roots[2], -1));
+    TEST_CASE("quartic, 2 roots, number of roots",
+              solve_quartic(1, 1, -1, 1, -2, roots) == 2);
+    TEST_CASE("quartic, 2 roots, correctness of roots",
+              are_almost_equal(roots[0], 1) && are_almost_equal(roots[1], -2));
+    TEST_CASE("quartic, 4 roots, number of roots",
+              solve_quartic(2, -20, 70, -100, 48, roots) == 4);
+    TEST_CASE("quartic, 4 roots, correctness of roots",
+              are_almost_equal(roots[0], 4) && are_almost_equal(roots[1], 3) &&
+              are_almost_equal(roots[2], 2) && are_almost_equal(roots[3], 1));
+    TEST_CASE("quartic, resolvent root close to 0, number of roots",
+              solve_quartic(1, 0, 1, 1.5e-10, 0, roots) == 1);
+    TEST_CASE("quartic, resolvent root close to 0, correctness of roots",
+              are_almost_equal(roots[0], 0));
+
+    /* Random quartics with 4 known distinct roots */
+    const size_t N_EQUATIONS = 1000;
+    const double ROOT_TOLERANCE = 1e-6;
+
+    double a[N_EQUATIONS] = {}, b[N_EQUATIONS] = {}, c[N_EQUATIONS] = {}, d[N_EQUATIONS] = {}, e[N_EQUATIONS] = {};
+    double expected_roots[N_EQUATIONS][4] = {};
+
+    srand(5);
+
+    for (size_t i = 0; i < N_EQUATIONS; ++i) {
+        /* Roots are spread at least 0.5 apart, so that they are well conditioned */
+        double root = 10.0 * rand() / RAND_MAX - 5;
+
+        for (int k = 0; k < 4; ++k) {
+            expected_roots[i][k] = root;
+            root -= 0.5 + 2.0 * rand() / RAND_MAX;
+        }
+
+        double x1 = expected_roots[i][0], x2 = expected_roots[i][1],
+               x3 = expected_roots[i][2], x4 = expected_roots[i][3];
+
+        a[i] = 1;
+        b[i] = -(x1 + x2 + x3 + x4);
+        c[i] = x1 * x2 + x1 * x3 + x1 * x4 + x2 * x3 + x2 * x4 + x3 * x4;
+        d[i] = -(x1 * x2 * x3 + x1 * x2 * x4 + x1 * x3 * x4 + x2 * x3 * x4);
+        e[i] = x1 * x2 * x3 * x4;
+    }
+
+    int n_roots[N_EQUATIONS] = {};
+    double root1[N_EQUATIONS] = {}, root2[N_EQUATIONS] = {}, root3[N_EQUATIONS] = {}, root4[N_EQUATIONS] = {};
+
+    solve_quartic_batch(a, b, c, d, e, N_EQUATIONS, n_roots, root1, root2, root3, root4);
+
+    int are_quartic_roots_correct = 1;
+
+    for (size_t i = 0; i < N_EQUATIONS; ++i) {
+        if ((n_roots[i] != 4) ||
+            (fabs(root1[i] - expected_roots[i][0]) > ROOT_TOLERANCE) ||
+            (fabs(root2[i] - expected_roots[i][1]) > ROOT_TOLERANCE) ||
+            (fabs(root3[i] - expected_roots[i][2]) > ROOT_TOLERANCE) ||
+            (fabs(root4[i] - expected_roots[i][3]) > ROOT_TOLERANCE)) {
+            are_quartic_roots_correct = 0;
+        }
+    }
+
+    TEST_CASE("solve_quartic_batch, random equations with 4 roots", are_quartic_roots_correct);
+
+    /* The cubics x^3 + bx^2 + cx + d whose roots are the greatest 3 roots of the quartics */
+    for (size_t i = 0; i < N_EQUATIONS; ++i) {
+        double x1 = expected_roots[i][0], x2 = expected_roots[i][1], x3 = expected_roots[i][2];
+
+        b[i] = -(x1 + x2 + x3);
+        c[i] = x1 * x2 + x1 * x3 + x2 * x3;
+        d[i] = -x1 * x2 * x3;
+    }
+
+    solve_cubic_batch(a, b, c, d, N_EQUATIONS, n_roots, root1, root2, root3);
+
+    int are_cubic_roots_correct = 1;
+
+    for (size_t i = 0; i < N_EQUATIONS; ++i) {
+        if ((n_roots[i] != 3) ||
+            (fabs(root1[i] - expected_roots[i][0]) > ROOT_TOLERANCE) ||
+            (fabs(root2[i] - expected_roots[i][1]) > ROOT_TOLERANCE) ||
+            (fabs(root3[i] - expected_roots[i][2]) > ROOT_TOLERANCE)) {
+            are_cubic_roots_correct = 0;
+        }
+    }
+
+    TEST_CASE("solve_cubic_batch, random equations with 3 roots", are_cubic_roots_correct);
+
+#undef TEST_CASE
+
+    printf("Finished testing solve_cubic and solve_quartic functions: %d tests passed, %d tests failed. "
+           "The total number of tests was: %d\n",
+           n_tests_passed, n_tests_failed, n_tests_passed + n_tests_failed);
+}
+
+/*!
+ * Coefficient grid of the compile-time root table checked by test_solve_square_constexpr
+ */
+constexpr double TEST_TABLE_A[] = {0, 1, 2, -0.5};
+constexpr double TEST_TABLE_B[] = {-3, 0, 1, 5};
+constexpr double TEST_TABLE_C[] = {-2, 0, 1, 3};
+
+/*!
+ * Compile-time root table checked by test_solve_square_constexpr
+ */
+constexpr square_root_table_t<double, 4, 4, 4> TEST_TABLE = make_square_root_table(TEST_TABLE_A, TEST_TABLE_B,
+                                                                                    TEST_TABLE_C);
+
+static_assert(TEST_TABLE.get(0, 1, 1).n_roots == INF_ROOTS, "0 = 0 has an infinite number of roots");
+static_assert(TEST_TABLE.get(0, 1, 2).n_roots == 0,         "1 = 0 has no roots");
+static_assert(TEST_TABLE.get(0, 2, 3).n_roots == 1,         "x + 3 = 0 has 1 root");
+static_assert(TEST_TABLE.get(0, 2, 3).root1 == -3,          "x + 3 = 0 has root -3");
+static_assert(TEST_TABLE.get(1, 0, 3).n_roots == 0,         "x^2 - 3x + 3 = 0 has no roots");
+static_assert(TEST_TABLE.get(2, 3, 3).n_roots == 2,         "2x^2 + 5x + 3 = 0 has 2 roots");
+static_assert(TEST_TABLE.get(2, 3, 3).root1 == -1 && TEST_TABLE.get(2, 3, 3).root2 == -1.5,
+              "2x^2 + 5x + 3 = 0 has roots -1 and -1.5");
+static_assert(TEST_TABLE.get(1, 1, 0).n_roots == 2,         "x^2 - 2 = 0 has 2 roots");
+static_assert(are_almost_equal_constexpr(TEST_TABLE.get(1, 1, 0).root1 * TEST_TABLE.get(1, 1, 0).root1, 2.0),
+              "x^2 - 2 = 0 has root sqrt(2)");
+static_assert([]() {
+                  float root1 = 0, root2 = 0;
+                  return solve_square_constexpr<float>(1, -2, 1, &root1, &root2) == 1 && root1 == 1;
+              }(), "x^2 - 2x + 1 = 0 has 1 root 1 in single precision");
+
+/*!
+ * Tests solve_square_constexpr function and the compile-time root table against solve_square
+ *
+ * @note The compile-time part of the test is done by the static assertions above
+ */
+void test_solve_square_constexpr(void)
+{
+    printf("Testing solve_square_constexpr function:\n");
+
+    int n_tests_passed = 0, n_tests_failed = 0;
+
+    int is_table_correct = 1;
+
+    for (size_t i_a = 0; i_a < 4; ++i_a) {
+        for (size_t i_b = 0; i_b < 4; ++i_b) {
+            for (size_t i_c = 0; i_c < 4; ++i_c) {
+                const square_roots_t<double> &entry = TEST_TABLE.get(i_a, i_b, i_c);
+
+                double root1 = 0, root2 = 0;
+                int n_roots = solve_square(TEST_TABLE_A[i_a], TEST_TABLE_B[i_b], TEST_TABLE_C[i_c], &root1, &root2);
+
+                if ((entry.n_roots != n_roots) || ((n_roots > 0) && (!are_almost_equal(entry.root1, root1) ||
+                                                                    !are_almost_equal(entry.root2, root2)))) {
+                    is_table_correct = 0;
+                }
+            }
+        }
+    }
+
+    (test_case("compile-time root table matches solve_square", is_table_correct) ? ++n_tests_passed : ++n_tests_failed);
+
+    const size_t N_VALUES = 100000;
+
+    int is_sqrt_correct = 1;
+
+    srand(6);
+
+    for (size_t i = 0; i < N_VALUES; ++i) {
+        double value = ldexp((double) rand() / RAND_MAX, rand() % 200 - 100);
+
+        double root = sqrt_constexpr(value), expected_root = sqrt(value);
+
+        if ((root != expected_root) && (nextafter(root, INFINITY) != expected_root) &&
+            (nextafter(root, 0.0) != expected_root)) {
+            is_sqrt_correct = 0;
+        }
+    }
+
+    (test_case("sqrt_constexpr is within 1 ulp of sqrt", is_sqrt_correct) ? ++n_tests_passed : ++n_tests_failed);
+
+    printf("Finished testing solve_square_constexpr function: %d tests passed, %d tests failed. "
+           "The total number of tests was: %d\n",
+           n_tests_passed, n_tests_failed, n_tests_passed + n_tests_failed);
+}
+
+/*!
+ * Tests solve_square_stable function
+ */
+void test_solve_square_stable(void)
+{
+    printf("Testing solve_square_stable function:\n");
+
+    double root1 = 0, root2 = 0;
+
+    int n_tests_passed = 0, n_tests_failed = 0;
+
+#define TEST_CASE(name, expr) (test_case((name), (expr)) ? ++n_tests_passed : ++n_tests_failed)
+
+    TEST_CASE("infinite number of roots",
+              solve_square_stable(0, 0, 0, &root1, &root2) == INF_ROOTS);
+    TEST_CASE("0 roots, quadratic equation",
+              solve_square_stable(1, 1, 1, &root1, &root2) == 0);
+    TEST_CASE("1 root, linear equation",
+              solve_square_stable(0, 1, 1, &root1, &root2) == 1 && are_almost_equal(root1, -1));
+    TEST_CASE("1 root, quadratic equation",
+              solve_square_stable(1, -2, 1, &root1, &root2) == 1 && are_almost_equal(root1, 1) && root1 == root2);
+    TEST_CASE("2 roots",
+              solve_square_stable(2, 5, 3, &root1, &root2) == 2 && root1 == -1 && root2 == -1.5);
+    TEST_CASE("2 roots, negative quadratic coefficient",
+              solve_square_stable(-1, 0, 4, &root1, &root2) == 2 && root1 == -2 && root2 == 2);
+    TEST_CASE("2 roots, cancellation",
+              solve_square_stable(1, 1e8, 1, &root1, &root2) == 2 &&
+              fabs(root1 / -1e-8 - 1) < 4 * DBL_EPSILON && are_almost_equal(root2, -1e8));
+
+    const size_t N_EQUATIONS = 1000;
+
+    double a[N_EQUATIONS] = {}, b[N_EQUATIONS] = {}, c[N_EQUATIONS] = {};
+    generate_test_coefficients(a, b, c, N_EQUATIONS, 29);
+
+    size_t n_order_mismatches = 0;
+
+    for (size_t i = 0; i < N_EQUATIONS; ++i) {
+        double stable_root1 = 0, stable_root2 = 0;
+
+        if ((solve_square(a[i], b[i], c[i], &root1, &root2) == 2) &&
+            (solve_square_stable(a[i], b[i], c[i], &stable_root1, &stable_root2) == 2) &&
+            (fabs(stable_root1 - root1) > fabs(stable_root1 - root2))) {
+            ++n_order_mismatches;
+        }
+    }
+
+    TEST_CASE("the same order of roots as of solve_square", n_order_mismatches == 0);
+    TEST_CASE("compensated discriminant, rounding error of b^2",
+              get_discriminant_compensated(0.25, 1 + ldexp(1, -30), 1 + ldexp(1, -29)) == ldexp(1, -60));
+
+    double_double_t reference_root1 = {}, reference_root2 = {};
+
+    TEST_CASE("reference solution, cancellation",
+              solve_square_reference(1, -(ldexp(1, 26) + ldexp(1, -26)), 1, &reference_root1, &reference_root2) == 2 &&
+              reference_root1.hi == ldexp(1, 26) && reference_root2.hi == ldexp(1, -26));
+    TEST_CASE("reference solution, number of roots from the exact discriminant",
+              solve_square_reference(0.5999197100885716, 1569.9993338763802, 1027178.2485727808,
+                                     &reference_root1, &reference_root2) == 2 &&
+              solve_square(0.5999197100885716, 1569.9993338763802, 1027178.2485727808, &root1, &root2) == 1);
+
+    double_double_t one_third = divide_double_double(make_double_double(1, 0), make_double_double(3, 0)),
+                    sqrt_two  = sqrt_double_double(make_double_double(2, 0));
+
+    double_double_t division_error = add_double_double(multiply_double_double(one_third, make_double_double(3, 0)),
+                                                       make_double_double(-1, 0)),
+                    sqrt_error     = add_double_double(multiply_double_double(sqrt_two, sqrt_two),
+                                                       make_double_double(-2, 0));
+
+    TEST_CASE("double-double division and square root",
+              (fabs(division_error.hi) < ldexp(1, -100)) && (fabs(sqrt_error.hi) < ldexp(1, -100)));
+
+#undef TEST_CASE
+
+    printf("Finished testing solve_square_stable function: %d tests passed, %d tests failed. "
+           "The total number of tests was: %d\n",
+           n_tests_passed, n_tests_failed, n_tests_passed + n_tests_failed);
+}
+
+/*!
+ * Tests the server: serves requests from pipes by read_server_requests, flush_server_batch and write_server_output
+ */
+void test_solve_square_server(void)
+{
+    printf("Testing the server:\n");
+
+    int n_tests_passed = 0, n_tests_failed = 0;
+
+#define TEST_CASE(name, expr) (test_case((name), (expr)) ? ++n_tests_passed : ++n_tests_failed)
+
+#ifdef _WIN32
+    printf("\tserver mode is not supported on Windows\n");
+#else
+    char output[MAX_SOLUTION_LEN * 8] = "";
+
+    const char *requests[] = {"1 -3 2\n1 2 1\n\n0 0 0\n1 0 1\n"};
+    TEST_CASE("parsing of requests",
+              serve_test_requests(requests, 1, 64, output, sizeof(output)) == 1 &&
+              strcmp(output, "2 2 1\n1 -1\ninf\n0\n") == 0);
+
+    const char *split_requests[] = {"1 -3", " 2\r\n1 2 1"};
+    TEST_CASE("requests split between reads, unterminated last request",
+              serve_test_requests(split_requests, 2, 64, output, sizeof(output)) == 1 &&
+              strcmp(output, "2 2 1\n1 -1\n") == 0);
+
+    const char *invalid_requests[] = {"1 -3 2\nx y z\n1 2 1\n"};
+    TEST_CASE("invalid request",
+              serve_test_requests(invalid_requests, 1, 64, output, sizeof(output)) == 1 &&
+              strcmp(output, "2 2 1\nERROR: invalid request\n1 -1\n") == 0);
+
+    char long_request[MAX_REQUEST_LEN + 2] = "";
+    memset(long_request, '7', MAX_REQUEST_LEN + 1);
+
+    const char *long_requests[] = {"1 -3 2\n", long_request, long_request, "7\n1 2 1\n"};
+    TEST_CASE("over-long request, skipped up to the next newline, with full batch",
+              serve_test_requests(long_requests, 4, 1, output, sizeof(output)) == 1 &&
+              strcmp(output, "2 2 1\nERROR: invalid request\n1 -1\n") == 0);
+
+    const char *quit_requests[] = {"1 -3 2\nQUIT\n1 2 1\n"};
+    TEST_CASE("QUIT request",
+              serve_test_requests(quit_requests, 1, 64, output, sizeof(output)) == 2 &&
+              strcmp(output, "2 2 1\n") == 0);
+#endif
+
+#undef TEST_CASE
+
+    printf("Finished testing the server: %d tests passed, %d tests failed. The total number of tests was: %d\n",
+           n_tests_passed, n_tests_failed, n_tests_passed + n_tests_failed);
+}
+
+#ifndef _WIN32
+/*!
+ * Serves requests, which are written to a pipe by parts, each part is read at once, and reads back the answers
+ *
+ * @param inputs [in] array of the parts of the requests
+ * @param n_inputs [in] the number of parts
+ * @param batch_size [in] the maximum number of requests solved at a time
+ * @param output [out] pointer to the buffer for the answers, which are null-terminated
+ * @param output_size [in] size of the buffer
+ *
+ * @return the status returned by read_server_requests for the last part or the end of input, -1 in case of error
+ */
+int serve_test_requests(const char *const *inputs, size_t n_inputs, size_t batch_size, char *output, size_t output_size)
+{
+    assert(inputs != NULL);
+    assert(output != NULL);
+    assert(output_size > 0);
+
+    output[0] = '\0';
+
+    int input_fds[2] = {-1, -1}, output_fds[2] = {-1, -1};
+
+    if (pipe(input_fds) == -1) {
+        return -1;
+    }
+
+    if (pipe(output_fds) == -1) {
+        close(input_fds[0]);
+        close(input_fds[1]);
+        return -1;
+    }
+
+    std::vector<server_client_t> clients(1, {input_fds[0], output_fds[1], {}, {}, 0, 0, 0});
+
+    server_batch_t batch = {};
+    init_server_batch(&batch, batch_size);
+
+    int status = 0;
+
+    for (size_t input_i = 0; (input_i < n_inputs) && (status == 0); ++input_i) {
+        size_t input_size = strlen(inputs[input_i]);
+
+        if (write(input_fds[1], inputs[input_i], input_size) != (ssize_t) input_size) {
+            status = -1;
+            break;
+        }
+
+        status = read_server_requests(&clients, 0, &batch);
+    }
+
+    close(input_fds[1]);
+
+    while (status == 0) {
+        status = read_server_requests(&clients, 0, &batch);
+    }
+
+    flush_server_batch(&clients, &batch);
+
+    if (write_server_output(&clients[0]) || !clients[0].output.empty()) {
+        status = -1;
+    }
+
+    close(output_fds[1]);
+
+    ssize_t n_read = read(output_fds[0], output, output_size - 1);
+    output[(n_read > 0) ? n_read : 0] = '\0';
+
+    close(input_fds[0]);
+    close(output_fds[0]);
+
+    return status;
+}
+#endif